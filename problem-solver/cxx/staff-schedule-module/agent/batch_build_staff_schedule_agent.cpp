@@ -0,0 +1,172 @@
+#include "batch_build_staff_schedule_agent.hpp"
+#include "builder/schedule_solver_class.hpp"
+#include "builder/staff_schedule_builder.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "metrics/staff_schedule_metrics.hpp"
+#include "solver/run_on_new_threads.hpp"
+#include "staff_schedule_module.h"
+
+#include <sc-memory/sc_memory.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+ScAddr BatchBuildStaffScheduleAgent::GetActionClass() const
+{
+  return StaffScheduleKeynodes::action_batch_build_staff_schedule;
+}
+
+ScResult BatchBuildStaffScheduleAgent::DoProgram(ScAction & action)
+{
+  m_logger.Debug("BatchBuildStaffScheduleAgent started");
+
+  try
+  {
+    auto const & [restaurantsAddr, solverAddr] = action.GetArguments<2>();
+    if (!m_context.IsElement(restaurantsAddr))
+    {
+      m_logger.Error("Restaurant set not specified.");
+      return action.FinishWithError();
+    }
+
+    vector<ScAddr> restaurants;
+    ScIterator3Ptr itRestaurants =
+        m_context.CreateIterator3(restaurantsAddr, ScType::ConstPermPosArc, ScType::ConstNode);
+    while (itRestaurants->Next())
+      restaurants.push_back(itRestaurants->Get(2));
+    if (restaurants.empty())
+    {
+      m_logger.Error("No restaurants in the set");
+      return action.FinishWithError();
+    }
+
+    auto const start = chrono::steady_clock::now();
+    StaffScheduleMetrics metrics;
+
+    // Ошибка одного ресторана не отменяет остальные: она записывается в результат рядом с рестораном.
+    vector<pair<ScAddr, string>> failures;
+    auto const fail = [&](ScAddr const & restaurantAddr, exception const & e) {
+      m_logger.Error("Schedule of restaurant is not built: " + string(e.what()));
+      failures.emplace_back(restaurantAddr, e.what());
+    };
+
+    vector<ScAddr> builderRestaurants;
+    vector<unique_ptr<StaffScheduleBuilder>> builders;
+    {
+      StaffScheduleMetrics::PhaseScope phase(metrics, "prepare");
+      for (ScAddr const & restaurantAddr : restaurants)
+      {
+        try
+        {
+          auto builder = make_unique<StaffScheduleBuilder>(m_context, m_logger);
+          StaffScheduleModule::GetStaffDataCache().Read(*builder, restaurantAddr);
+          if (builder->GetEmployees().empty() || builder->GetShifts().empty())
+          {
+            m_logger.Warning("Restaurant without employees or shifts skipped");
+            continue;
+          }
+
+          builder->BuildFlowNetwork();
+          builders.push_back(move(builder));
+          builderRestaurants.push_back(restaurantAddr);
+        }
+        catch (exception const & e)
+        {
+          fail(restaurantAddr, e);
+        }
+      }
+      metrics.AddCounter("schedules", builders.size());
+    }
+
+    size_t threadCount = 0;
+    vector<exception_ptr> flowErrors(builders.size());
+    {
+      StaffScheduleMetrics::PhaseScope phase(metrics, "max_flow");
+      // Сети ресторанов независимы, а поиск потока не обращается к sc-памяти.
+      ScheduleSolverType const solverType = GetScheduleSolverType(m_context, m_logger, solverAddr);
+      threadCount = RunOnNewThreads(builders.size(), [&](size_t i) {
+        try
+        {
+          builders[i]->FindMaxFlow(solverType);
+        }
+        catch (...)
+        {
+          flowErrors[i] = current_exception();
+        }
+      });
+      metrics.AddCounter("threads", threadCount);
+    }
+
+    ScStructure result = m_context.GenerateStructure();
+    size_t builtCount = 0;
+    double schedulesPerSecond = 0;
+    {
+      StaffScheduleMetrics::PhaseScope phase(metrics, "write_schedule");
+      bool const updateInPlace = m_context.CheckConnector(
+          StaffScheduleKeynodes::concept_schedule_update_in_place, action, ScType::ConstPermPosArc);
+      for (size_t i = 0; i < builders.size(); ++i)
+      {
+        try
+        {
+          if (flowErrors[i])
+            rethrow_exception(flowErrors[i]);
+          StaffScheduleBuilder & builder = *builders[i];
+          ScStructure schedule = updateInPlace ? builder.UpdateSchedule() : builder.WriteSchedule();
+          builder.WriteMetrics(schedule);
+          result << schedule << builder.GetScheduleAddr();
+          ++builtCount;
+        }
+        catch (exception const & e)
+        {
+          fail(builderRestaurants[i], e);
+        }
+      }
+
+      double const seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      schedulesPerSecond = seconds > 0 ? builtCount / seconds : 0;
+      metrics.AddCounter("schedules_per_second", static_cast<size_t>(lround(schedulesPerSecond)));
+      metrics.AddCounter("failed", failures.size());
+    }
+
+    for (auto const & [restaurantAddr, message] : failures)
+    {
+      ScAddr errorLink = m_context.GenerateLink();
+      m_context.SetLinkContent(errorLink, message);
+      ScAddr errorArc = m_context.GenerateConnector(ScType::ConstCommonArc, restaurantAddr, errorLink);
+      m_context.GenerateConnector(ScType::ConstPermPosArc, StaffScheduleKeynodes::nrel_schedule_error, errorArc);
+      result << restaurantAddr << errorLink << errorArc;
+    }
+
+    // Метрики всего пакета прикрепляются к результату так же, как метрики отдельного графика.
+    ScAddr metricsLink = m_context.GenerateLink();
+    m_context.SetLinkContent(metricsLink, metrics.ToJson());
+    ScAddr metricsArc = m_context.GenerateConnector(ScType::ConstCommonArc, result, metricsLink);
+    m_context.GenerateConnector(ScType::ConstPermPosArc, StaffScheduleKeynodes::nrel_schedule_metrics, metricsArc);
+    result << metricsLink << metricsArc;
+    action.SetResult(result);
+
+    m_logger.Info(
+        "Built " + to_string(builtCount) + " of " + to_string(restaurants.size()) + " schedules on "
+        + to_string(threadCount) + " threads, " + to_string(schedulesPerSecond) + " schedules per second");
+    if (!failures.empty())
+    {
+      m_logger.Warning(
+          "BatchBuildStaffScheduleAgent finished with " + to_string(failures.size()) + " failed restaurants");
+      return action.FinishUnsuccessfully();
+    }
+    m_logger.Info("BatchBuildStaffScheduleAgent finished successfully");
+    return action.FinishSuccessfully();
+  }
+  catch (exception const & e)
+  {
+    m_logger.Error("BatchBuildStaffScheduleAgent error: " + string(e.what()));
+    return action.FinishWithError();
+  }
+}
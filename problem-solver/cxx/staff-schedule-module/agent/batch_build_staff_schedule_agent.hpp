@@ -0,0 +1,16 @@
+#pragma once
+
+#include <sc-memory/sc_agent.hpp>
+
+/*!
+ * Builds schedules for every restaurant of the given set. Networks are read and written one by one,
+ * flows are found concurrently, one thread per physical core at most. A restaurant that fails does not
+ * stop the others: its error is added to the result with nrel_schedule_error, and the action finishes
+ * unsuccessfully with the schedules that were built.
+ */
+class BatchBuildStaffScheduleAgent : public ScActionInitiatedAgent
+{
+public:
+  ScAddr GetActionClass() const override;
+  ScResult DoProgram(ScAction & action) override;
+};
@@ -0,0 +1,116 @@
+#include "find_substitute_agent.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+#include <sc-memory/sc_memory.hpp>
+
+using namespace std;
+
+namespace
+{
+//! Назначение из текущего графика ресторана; назначения прежних графиков могут хранить устаревшие замены.
+bool IsInCurrentSchedule(ScMemoryContext & context, ScAddr const & assignedArc)
+{
+  ScIterator3Ptr itSchedule = context.CreateIterator3(ScType::ConstNode, ScType::ConstPermPosArc, assignedArc);
+  while (itSchedule->Next())
+  {
+    ScIterator5Ptr itRestaurant = context.CreateIterator5(
+        ScType::ConstNode,
+        ScType::ConstCommonArc,
+        itSchedule->Get(0),
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_current_schedule);
+    if (itRestaurant->Next())
+      return true;
+  }
+  return false;
+}
+}  // namespace
+
+ScAddr FindSubstituteAgent::GetActionClass() const
+{
+  return StaffScheduleKeynodes::action_find_substitute;
+}
+
+ScResult FindSubstituteAgent::DoProgram(ScAction & action)
+{
+  m_logger.Debug("FindSubstituteAgent started");
+
+  try
+  {
+    auto const & [shiftAddr, employeeAddr] = action.GetArguments<2>();
+    if (!m_context.IsElement(shiftAddr) || !m_context.IsElement(employeeAddr))
+    {
+      m_logger.Error("Shift or employee not specified.");
+      return action.FinishWithError();
+    }
+
+    // Замены упорядочены ролями rrel_1, rrel_2 и т. д., лучшая берётся без перебора.
+    ScAddr substitution;
+    ScIterator5Ptr itAssigned = m_context.CreateIterator5(
+        shiftAddr,
+        ScType::ConstCommonArc,
+        employeeAddr,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_assigned_employee);
+    while (!substitution.IsValid() && itAssigned->Next())
+    {
+      if (!IsInCurrentSchedule(m_context, itAssigned->Get(1)))
+        continue;
+
+      ScIterator5Ptr itList = m_context.CreateIterator5(
+          itAssigned->Get(1),
+          ScType::ConstCommonArc,
+          ScType::ConstNodeTuple,
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::nrel_substitutes);
+      if (!itList->Next())
+        continue;
+
+      ScIterator5Ptr itBest = m_context.CreateIterator5(
+          itList->Get(2),
+          ScType::ConstPermPosArc,
+          ScType::ConstNode,
+          ScType::ConstPermPosArc,
+          ScKeynodes::GetRrelIndex(1));
+      if (itBest->Next())
+        substitution = itBest->Get(2);
+    }
+
+    if (!substitution.IsValid())
+    {
+      m_logger.Warning("No substitute found for the employee in the shift");
+      return action.FinishUnsuccessfully();
+    }
+
+    // В результат входят замена и перемещения сотрудников, которых она требует.
+    ScStructure result = m_context.GenerateStructure();
+    result << substitution;
+    ScIterator5Ptr itSubstitute = m_context.CreateIterator5(
+        substitution,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_substitute);
+    if (itSubstitute->Next())
+      result << itSubstitute->Get(1) << itSubstitute->Get(2);
+
+    ScIterator3Ptr itMove = m_context.CreateIterator3(substitution, ScType::ConstPermPosArc, ScType::ConstNode);
+    while (itMove->Next())
+    {
+      ScAddr const & move = itMove->Get(2);
+      result << itMove->Get(1) << move;
+      ScIterator3Ptr itMoveArc = m_context.CreateIterator3(move, ScType::ConstCommonArc, ScType::ConstNode);
+      while (itMoveArc->Next())
+        result << itMoveArc->Get(1) << itMoveArc->Get(2);
+    }
+    action.SetResult(result);
+
+    m_logger.Info("FindSubstituteAgent finished successfully");
+    return action.FinishSuccessfully();
+  }
+  catch (exception const & e)
+  {
+    m_logger.Error("FindSubstituteAgent error: " + string(e.what()));
+    return action.FinishWithError();
+  }
+}
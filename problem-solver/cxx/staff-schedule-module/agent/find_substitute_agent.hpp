@@ -0,0 +1,14 @@
+#pragma once
+
+#include <sc-memory/sc_agent.hpp>
+
+/*!
+ * Answers who replaces an employee in a shift from substitutions written with the schedule,
+ * without searching: returns the best substitution of the assignment in the current schedule.
+ */
+class FindSubstituteAgent : public ScActionInitiatedAgent
+{
+public:
+  ScAddr GetActionClass() const override;
+  ScResult DoProgram(ScAction & action) override;
+};
@@ -0,0 +1,71 @@
+#include "repair_staff_schedule_agent.hpp"
+#include "builder/staff_schedule_builder.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "staff_schedule_module.h"
+
+#include <sc-memory/sc_memory.hpp>
+
+#include <string>
+
+using namespace std;
+
+ScAddr RepairStaffScheduleAgent::GetActionClass() const
+{
+  return StaffScheduleKeynodes::action_repair_staff_schedule;
+}
+
+ScResult RepairStaffScheduleAgent::DoProgram(ScAction & action)
+{
+  m_logger.Debug("RepairStaffScheduleAgent started");
+
+  try
+  {
+    auto const & [restaurantAddr, scheduleAddr] = action.GetArguments<2>();
+    if (!m_context.IsElement(restaurantAddr))
+    {
+      m_logger.Error("Restaurant not specified.");
+      return action.FinishWithError();
+    }
+
+    bool const isSchedule = m_context.IsElement(scheduleAddr)
+                            && m_context.CheckConnector(
+                                StaffScheduleKeynodes::concept_week_schedule, scheduleAddr, ScType::ConstPermPosArc);
+    if (!isSchedule)
+    {
+      m_logger.Error("Schedule to repair not specified.");
+      return action.FinishWithError();
+    }
+
+    StaffScheduleBuilder builder(m_context, m_logger);
+    StaffScheduleModule::GetStaffDataCache().Read(builder, restaurantAddr);
+
+    if (builder.GetEmployees().empty())
+    {
+      m_logger.Error("No employees found for restaurant");
+      return action.FinishWithError();
+    }
+
+    builder.BuildFlowNetwork();
+
+    // Прежние назначения, которые всё ещё допустимы, становятся начальным потоком, и тот же решатель,
+    // что построил график, лишь дополняет его. Решатели со стоимостями учитывают её только для новых назначений.
+    size_t const restored = builder.LoadSchedule(scheduleAddr);
+    size_t const flow = builder.FindMaxFlow(builder.GetLoadedSolverType());
+    m_logger.Info(
+        "Kept " + to_string(restored) + " assignments, matched " + to_string(flow) + " of "
+        + to_string(builder.GetSlotCount()) + " shift slots");
+
+    ScStructure result = builder.RepairSchedule();
+    builder.WriteMetrics(result);
+    m_logger.Info("Repair metrics: " + builder.GetMetrics().ToJson());
+    action.SetResult(result);
+
+    m_logger.Info("RepairStaffScheduleAgent finished successfully");
+    return action.FinishSuccessfully();
+  }
+  catch (exception const & e)
+  {
+    m_logger.Error("RepairStaffScheduleAgent error: " + string(e.what()));
+    return action.FinishWithError();
+  }
+}
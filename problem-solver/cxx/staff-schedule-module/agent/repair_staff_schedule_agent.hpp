@@ -0,0 +1,10 @@
+#pragma once
+
+#include <sc-memory/sc_agent.hpp>
+
+class RepairStaffScheduleAgent : public ScActionInitiatedAgent
+{
+public:
+  ScAddr GetActionClass() const override;
+  ScResult DoProgram(ScAction & action) override;
+};
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark/staff_schedule_benchmark_utils.hpp"
+#include "builder/staff_schedule_builder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+namespace
+{
+// Пик RSS процесса только растёт, поэтому перед стадией он сбрасывается до текущего RSS (Linux 4.0+).
+bool ResetPeakRss()
+{
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+  return static_cast<bool>(clearRefs.flush());
+}
+
+long ReadPeakRssKb()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.rfind("VmHWM:", 0) == 0)
+      return std::stol(line.substr(6));
+  }
+  return 0;
+}
+
+struct PhaseMeasure
+{
+  double seconds = 0;
+  double elements = 0;
+  //! Largest RSS reached inside the phase over all iterations; stays 0 if the peak cannot be reset.
+  double peakRssKb = 0;
+};
+
+template <typename TPhase>
+void MeasurePhase(ScMemoryContext & ctx, PhaseMeasure & measure, TPhase && phase)
+{
+  bool const peakReset = ResetPeakRss();
+  auto const elementsBefore = ctx.CalculateStat().GetAllNum();
+  auto const start = std::chrono::steady_clock::now();
+
+  phase();
+
+  auto const end = std::chrono::steady_clock::now();
+  measure.seconds += std::chrono::duration<double>(end - start).count();
+  measure.elements += static_cast<double>(ctx.CalculateStat().GetAllNum() - elementsBefore);
+  if (peakReset)
+    measure.peakRssKb = std::max(measure.peakRssKb, static_cast<double>(ReadPeakRssKb()));
+}
+
+void ReportPhase(benchmark::State & state, std::string const & name, PhaseMeasure const & measure)
+{
+  state.counters[name + "_ms"] = benchmark::Counter(measure.seconds * 1000, benchmark::Counter::kAvgIterations);
+  state.counters[name + "_elements"] = benchmark::Counter(measure.elements, benchmark::Counter::kAvgIterations);
+  if (measure.peakRssKb > 0)
+    state.counters[name + "_peak_rss_kb"] = benchmark::Counter(measure.peakRssKb);
+}
+}  // namespace
+
+// Аргументы: число сотрудников, число смен в неделе и 1, если ресторан задаёт правила дней.
+// Цена правил — разница с тем же рестораном без них; снятие конфликтов отдыха входит в solve.
+static void BM_BuildStaffSchedule(benchmark::State & state)
+{
+  size_t const employeeCount = static_cast<size_t>(state.range(0));
+  size_t const shiftCount = static_cast<size_t>(state.range(1));
+  bool const dayRules = state.range(2) != 0;
+
+  PhaseMeasure read;
+  PhaseMeasure build;
+  PhaseMeasure solve;
+  PhaseMeasure write;
+
+  for (auto _ : state)
+  {
+    StaffScheduleMemory memory;
+    ScMemoryContext & ctx = memory.Context();
+    ScAddr restaurant = GenerateRestaurant(ctx, employeeCount, shiftCount);
+    if (dayRules)
+      AddDayRules(ctx, restaurant);
+
+    utils::ScLogger logger;
+    StaffScheduleBuilder builder(ctx, logger);
+
+    double const measuredBefore = read.seconds + build.seconds + solve.seconds + write.seconds;
+
+    MeasurePhase(ctx, read, [&]() {
+      builder.ReadStaffData(restaurant);
+    });
+    MeasurePhase(ctx, build, [&]() {
+      builder.BuildFlowNetwork();
+    });
+    MeasurePhase(ctx, solve, [&]() {
+      benchmark::DoNotOptimize(builder.FindMaxFlow());
+    });
+    MeasurePhase(ctx, write, [&]() {
+      benchmark::DoNotOptimize(builder.WriteSchedule());
+    });
+
+    state.SetIterationTime(read.seconds + build.seconds + solve.seconds + write.seconds - measuredBefore);
+  }
+
+  ReportPhase(state, "read", read);
+  ReportPhase(state, "build", build);
+  ReportPhase(state, "solve", solve);
+  ReportPhase(state, "write", write);
+}
+
+BENCHMARK(BM_BuildStaffSchedule)
+    ->Args({10, 21, 0})
+    ->Args({100, 70, 0})
+    ->Args({500, 210, 0})
+    ->Args({1000, 350, 0})
+    ->Args({1000, 350, 1})
+    ->Args({2000, 600, 0})
+    ->Args({5000, 2000, 0})
+    ->Args({5000, 2000, 1})
+    ->Iterations(1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,256 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark/staff_schedule_benchmark_utils.hpp"
+#include "builder/staff_schedule_builder.hpp"
+#include "solver/decomposed_max_flow.hpp"
+#include "solver/schedule_solver.hpp"
+#include "solver/weighted_max_flow.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// Прежняя реализация поиска блокирующего потока: рекурсивный обход через std::function,
+// по одному пути за вызов. Оставлена для сравнения с движками ScheduleSolver.
+int RunRecursiveDinic(FlowNetwork & network, size_t source, size_t sink)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  std::vector<int> level(nodeCount, -1);
+  std::vector<size_t> itPtr(nodeCount, 0);
+  std::vector<int> queue;
+  queue.reserve(nodeCount);
+
+  auto bfs = [&]() -> bool {
+    std::fill(level.begin(), level.end(), -1);
+    queue.clear();
+    queue.push_back(static_cast<int>(source));
+    level[source] = 0;
+    for (size_t qi = 0; qi < queue.size(); ++qi)
+    {
+      int v = queue[qi];
+      for (size_t a = network.ArcsBegin(v); a < network.ArcsEnd(v); ++a)
+      {
+        FlowNetwork::Arc const & arc = network.GetArc(a);
+        if (arc.cap > 0 && level[arc.to] == -1)
+        {
+          level[arc.to] = level[v] + 1;
+          queue.push_back(arc.to);
+        }
+      }
+    }
+    return level[sink] != -1;
+  };
+
+  std::function<int(int, int)> dfs = [&](int v, int pushed) -> int {
+    if (pushed == 0)
+      return 0;
+    if (v == static_cast<int>(sink))
+      return pushed;
+    for (size_t & a = itPtr[v]; a < network.ArcsEnd(v); ++a)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      if (arc.cap > 0 && level[arc.to] == level[v] + 1)
+      {
+        int tr = dfs(arc.to, std::min(pushed, arc.cap));
+        if (tr == 0)
+          continue;
+        network.Push(a, tr);
+        return tr;
+      }
+    }
+    return 0;
+  };
+
+  int flow = 0;
+  while (bfs())
+  {
+    for (size_t v = 0; v < nodeCount; ++v)
+      itPtr[v] = network.ArcsBegin(v);
+    while (int pushed = dfs(static_cast<int>(source), 1 << 30))
+      flow += pushed;
+  }
+  return flow;
+}
+
+struct ScheduleNetwork
+{
+  FlowNetwork network;
+  size_t source = 0;
+  size_t sink = 0;
+  std::vector<size_t> dayParts;
+  std::vector<int> preferenceCosts;
+};
+
+// Сеть строится один раз на бенчмарк, каждая итерация решает её копию.
+ScheduleNetwork BuildScheduleNetwork(
+    size_t employeeCount,
+    size_t shiftCount,
+    bool dayRules = false,
+    bool preferences = false)
+{
+  StaffScheduleMemory memory;
+  ScMemoryContext & ctx = memory.Context();
+  ScAddr restaurant = employeeCount == 0 ? GenerateGourmanRestaurant(ctx)
+                                         : GenerateRestaurant(ctx, employeeCount, shiftCount);
+  if (dayRules)
+    AddDayRules(ctx, restaurant);
+  if (preferences)
+    AddShiftPreferences(ctx, restaurant);
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder builder(ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+
+  return {
+      builder.GetNetwork(),
+      builder.GetSource(),
+      builder.GetSink(),
+      builder.GetDemandDayParts(),
+      builder.GetPreferenceCosts()};
+}
+
+// Стандартное отклонение нагрузки сотрудников: поток дуги из истока лежит в ёмкости обратной дуги.
+double GetLoadDeviation(FlowNetwork const & network, size_t source)
+{
+  std::vector<double> loads;
+  for (size_t a = network.ArcsBegin(source); a < network.ArcsEnd(source); ++a)
+    loads.push_back(network.GetArc(static_cast<size_t>(network.GetArc(a).rev)).cap);
+  if (loads.empty())
+    return 0;
+
+  double const mean = std::accumulate(loads.begin(), loads.end(), 0.0) / loads.size();
+  double variance = 0;
+  for (double load : loads)
+    variance += (load - mean) * (load - mean);
+  return std::sqrt(variance / loads.size());
+}
+
+template <typename TSolve>
+void RunMaxFlowBenchmark(benchmark::State & state, ScheduleNetwork const & schedule, TSolve && solve)
+{
+  int flow = 0;
+  FlowNetwork network;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    network = schedule.network;
+    state.ResumeTiming();
+
+    flow = solve(network, schedule.source, schedule.sink);
+    benchmark::DoNotOptimize(flow);
+  }
+
+  state.counters["flow"] = flow;
+  state.counters["load_deviation"] = GetLoadDeviation(network, schedule.source);
+  state.counters["edges"] = static_cast<double>(schedule.network.GetEdgeCount());
+}
+
+template <typename TSolve>
+void RunMaxFlowBenchmark(benchmark::State & state, TSolve && solve)
+{
+  RunMaxFlowBenchmark(
+      state,
+      BuildScheduleNetwork(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1))),
+      std::forward<TSolve>(solve));
+}
+}  // namespace
+
+// Аргументы: число сотрудников и число смен; {0, 0} означает ресторан restaurant_gourman.
+static void BM_RecursiveDinic(benchmark::State & state)
+{
+  RunMaxFlowBenchmark(state, [](FlowNetwork & network, size_t source, size_t sink) {
+    return RunRecursiveDinic(network, source, sink);
+  });
+}
+
+static void BM_ScheduleSolver(benchmark::State & state, ScheduleSolverType type)
+{
+  std::unique_ptr<ScheduleSolver> solver = CreateScheduleSolver(type);
+  RunMaxFlowBenchmark(state, [&solver](FlowNetwork & network, size_t source, size_t sink) {
+    return solver->Solve(network, source, sink);
+  });
+}
+
+// Сеть с вершинами дней сотрудников; сравнивается с BM_ScheduleSolver на тех же аргументах.
+static void BM_DayLimitedSolver(benchmark::State & state, ScheduleSolverType type)
+{
+  std::unique_ptr<ScheduleSolver> solver = CreateScheduleSolver(type);
+  ScheduleNetwork const schedule =
+      BuildScheduleNetwork(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)), true);
+  RunMaxFlowBenchmark(state, schedule, [&solver](FlowNetwork & network, size_t source, size_t sink) {
+    return solver->Solve(network, source, sink);
+  });
+  state.counters["nodes"] = static_cast<double>(schedule.network.GetNodeCount());
+}
+
+// Сотрудники с предпочтениями; сеть та же, что у BM_ScheduleSolver, добавляются только стоимости дуг.
+static void BM_PreferenceSolver(benchmark::State & state)
+{
+  ScheduleNetwork const schedule =
+      BuildScheduleNetwork(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)), false, true);
+  WeightedMaxFlow solver(schedule.preferenceCosts);
+  RunMaxFlowBenchmark(state, schedule, [&solver](FlowNetwork & network, size_t source, size_t sink) {
+    return solver.Solve(network, source, sink);
+  });
+  for (auto const & [name, value] : solver.GetCounters())
+    state.counters[name] = static_cast<double>(value);
+}
+
+// Потребности делятся по дням смен, как в StaffScheduleBuilder::FindMaxFlow.
+static void BM_DecomposedByDay(benchmark::State & state)
+{
+  ScheduleNetwork const schedule =
+      BuildScheduleNetwork(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+  DecomposedMaxFlow solver(schedule.dayParts);
+  RunMaxFlowBenchmark(state, schedule, [&solver](FlowNetwork & network, size_t source, size_t sink) {
+    return solver.Solve(network, source, sink);
+  });
+  for (auto const & [name, value] : solver.GetCounters())
+    state.counters[name] = static_cast<double>(value);
+}
+
+BENCHMARK(BM_RecursiveDinic)->Args({0, 0})->Args({1000, 350})->Args({5000, 210})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ScheduleSolver, dinic, ScheduleSolverType::Dinic)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ScheduleSolver, hopcroft_karp, ScheduleSolverType::HopcroftKarp)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ScheduleSolver, push_relabel, ScheduleSolverType::PushRelabel)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ScheduleSolver, decomposed, ScheduleSolverType::Decomposed)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecomposedByDay)->Args({0, 0})->Args({1000, 350})->Args({5000, 210})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ScheduleSolver, min_cost, ScheduleSolverType::MinCost)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DayLimitedSolver, dinic, ScheduleSolverType::Dinic)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DayLimitedSolver, min_cost, ScheduleSolverType::MinCost)
+    ->Args({0, 0})
+    ->Args({1000, 350})
+    ->Args({5000, 210})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PreferenceSolver)->Args({0, 0})->Args({1000, 350})->Args({5000, 210})->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark/staff_schedule_benchmark_utils.hpp"
+#include "builder/staff_schedule_builder.hpp"
+
+// Аргументы: число сотрудников, число смен и число других ресторанов такого же размера в базе.
+// Обход отношений читает сотрудников всех ресторанов, поэтому третий аргумент показывает его цену;
+// смены читаются только свои.
+static void BM_ReadStaffData(benchmark::State & state, StaffDataReadMode mode)
+{
+  size_t const employeeCount = static_cast<size_t>(state.range(0));
+  size_t const shiftCount = static_cast<size_t>(state.range(1));
+  size_t const otherRestaurantCount = static_cast<size_t>(state.range(2));
+
+  StaffScheduleMemory memory;
+  ScMemoryContext & ctx = memory.Context();
+  ScAddr restaurant = GenerateRestaurant(ctx, employeeCount, shiftCount);
+  for (size_t i = 0; i < otherRestaurantCount; ++i)
+    GenerateRestaurant(ctx, employeeCount, shiftCount);
+
+  size_t iteratorCalls = 0;
+  for (auto _ : state)
+  {
+    utils::ScLogger logger;
+    StaffScheduleBuilder builder(ctx, logger);
+    builder.ReadStaffData(restaurant, mode);
+    benchmark::DoNotOptimize(builder.GetEmployees().data());
+    iteratorCalls = builder.GetMetrics().GetPhases().front().iteratorCalls;
+  }
+  state.counters["iterator_calls"] = static_cast<double>(iteratorCalls);
+}
+
+BENCHMARK_CAPTURE(BM_ReadStaffData, per_entity, StaffDataReadMode::PerEntity)
+    ->Args({100, 70, 0})
+    ->Args({1000, 350, 0})
+    ->Args({5000, 210, 0})
+    ->Args({1000, 350, 4})
+    ->Args({1000, 350, 16})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ReadStaffData, relation_scan, StaffDataReadMode::RelationScan)
+    ->Args({100, 70, 0})
+    ->Args({1000, 350, 0})
+    ->Args({5000, 210, 0})
+    ->Args({1000, 350, 4})
+    ->Args({1000, 350, 16})
+    ->Unit(benchmark::kMillisecond);
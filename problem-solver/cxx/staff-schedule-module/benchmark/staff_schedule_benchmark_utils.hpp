@@ -0,0 +1,188 @@
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <array>
+#include <initializer_list>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class StaffScheduleMemory
+{
+public:
+  StaffScheduleMemory()
+  {
+    sc_memory_params params;
+    sc_memory_params_clear(&params);
+    params.clear = true;
+    params.repo_path = "staff-schedule-benchmark-repo";
+    params.log_level = "Error";
+
+    ScMemory::LogMute();
+    ScMemory::Initialize(params);
+    m_context = std::make_unique<ScMemoryContext>();
+  }
+
+  ~StaffScheduleMemory()
+  {
+    m_context.reset();
+    ScMemory::Shutdown(false);
+    ScMemory::LogUnmute();
+  }
+
+  ScMemoryContext & Context()
+  {
+    return *m_context;
+  }
+
+private:
+  std::unique_ptr<ScMemoryContext> m_context;
+};
+
+// Смене назначается день недели, как в базе знаний.
+inline void AddShiftWithDay(
+    ScMemoryContext & ctx,
+    ScAddr const & restaurant,
+    ScAddr const & shiftType,
+    ScAddr const & day)
+{
+  ScAddr shift = CreateShift(ctx, shiftType);
+  AddRelation(ctx, shift, day, StaffScheduleKeynodes::nrel_shift_day);
+  AddShiftToRestaurant(ctx, restaurant, shift);
+}
+
+// Дни связаны nrel_next_day в кольцо, как в базе знаний.
+inline std::array<ScAddr, 7> GenerateWeekDays(ScMemoryContext & ctx)
+{
+  std::array<ScAddr, 7> days;
+  for (ScAddr & day : days)
+    day = ctx.GenerateNode(ScType::ConstNode);
+  for (size_t i = 0; i < days.size(); ++i)
+    AddRelation(ctx, days[i], days[(i + 1) % days.size()], StaffScheduleKeynodes::nrel_next_day);
+  return days;
+}
+
+// Утренняя, дневная и ночная смены с часами из базы знаний.
+inline std::array<ScAddr, 3> GenerateShiftTypes(ScMemoryContext & ctx)
+{
+  std::array<ScAddr, 3> shiftTypes;
+  std::array<char const *, 4> const hours = {"6", "14", "22", "6"};
+  for (size_t i = 0; i < shiftTypes.size(); ++i)
+  {
+    shiftTypes[i] = CreateShiftType(ctx);
+    AddCount(ctx, shiftTypes[i], StaffScheduleKeynodes::nrel_start_hour, hours[i]);
+    AddCount(ctx, shiftTypes[i], StaffScheduleKeynodes::nrel_end_hour, hours[i + 1]);
+  }
+  return shiftTypes;
+}
+
+// Правила дней restaurant_gourman: не больше одной смены в день и 11 часов отдыха между сменами.
+inline void AddDayRules(ScMemoryContext & ctx, ScAddr const & restaurant)
+{
+  AddCount(ctx, restaurant, StaffScheduleKeynodes::nrel_max_shifts_per_day, "1");
+  AddCount(ctx, restaurant, StaffScheduleKeynodes::nrel_min_rest_hours, "11");
+}
+
+// Каждый сотрудник ресторана предпочитает один из доступных типов смен с весом от 1 до 3.
+inline void AddShiftPreferences(ScMemoryContext & ctx, ScAddr const & restaurant)
+{
+  std::mt19937 random(43);
+  ScIterator5Ptr itEmployees = ctx.CreateIterator5(
+      restaurant,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_employee);
+  while (itEmployees->Next())
+  {
+    std::vector<ScAddr> shiftTypes;
+    ScIterator5Ptr itShiftTypes = ctx.CreateIterator5(
+        itEmployees->Get(2),
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_available_shift_type);
+    while (itShiftTypes->Next())
+      shiftTypes.push_back(itShiftTypes->Get(2));
+    if (!shiftTypes.empty())
+    {
+      AddPreferredShiftType(
+          ctx, itEmployees->Get(2), shiftTypes[random() % shiftTypes.size()], std::to_string(1 + random() % 3));
+    }
+  }
+}
+
+// Ресторан строится теми же функциями, что и в тестах агента: 3 типа смен, смены распределены по дням,
+// роли и доступность сотрудников выбираются детерминированно.
+inline ScAddr GenerateRestaurant(ScMemoryContext & ctx, size_t employeeCount, size_t shiftCount)
+{
+  std::mt19937 random(42);
+
+  ScAddr restaurant = CreateRestaurant(ctx);
+  std::array<ScAddr, 3> shiftTypes = GenerateShiftTypes(ctx);
+
+  std::array<ScAddr, 7> days = GenerateWeekDays(ctx);
+
+  for (size_t i = 0; i < shiftCount; ++i)
+    AddShiftWithDay(ctx, restaurant, shiftTypes[i % shiftTypes.size()], days[i / shiftTypes.size() % days.size()]);
+
+  std::array<ScAddr, 5> roles = {
+      StaffScheduleKeynodes::concept_cook,
+      StaffScheduleKeynodes::concept_waiter,
+      StaffScheduleKeynodes::concept_waiter,
+      StaffScheduleKeynodes::concept_cleaner,
+      StaffScheduleKeynodes::concept_admin};
+
+  for (size_t i = 0; i < employeeCount; ++i)
+  {
+    size_t firstType = random() % shiftTypes.size();
+    ScAddr employee = CreateEmployeeWithMax(
+        ctx, roles[i % roles.size()], shiftTypes[firstType], std::to_string(3 + random() % 3));
+    if (random() % 2 == 0)
+    {
+      AddRelation(
+          ctx,
+          employee,
+          shiftTypes[(firstType + 1) % shiftTypes.size()],
+          StaffScheduleKeynodes::nrel_available_shift_type);
+    }
+    AddEmployeeToRestaurant(ctx, restaurant, employee);
+  }
+
+  return restaurant;
+}
+
+// Повторяет restaurant_gourman из базы знаний: 12 сотрудников и 21 смена (7 дней, утро/день/ночь).
+inline ScAddr GenerateGourmanRestaurant(ScMemoryContext & ctx)
+{
+  ScAddr restaurant = CreateRestaurant(ctx);
+  auto const [morning, day, night] = GenerateShiftTypes(ctx);
+
+  for (ScAddr const & weekDay : GenerateWeekDays(ctx))
+  {
+    for (ScAddr const & shiftType : {morning, day, night})
+      AddShiftWithDay(ctx, restaurant, shiftType, weekDay);
+  }
+
+  auto addEmployees = [&](ScAddr const & role, size_t count, std::initializer_list<ScAddr> shiftTypes) {
+    for (size_t i = 0; i < count; ++i)
+    {
+      ScAddr employee = CreateEmployee(ctx, role, *shiftTypes.begin());
+      for (auto it = shiftTypes.begin() + 1; it != shiftTypes.end(); ++it)
+        AddRelation(ctx, employee, *it, StaffScheduleKeynodes::nrel_available_shift_type);
+      AddEmployeeToRestaurant(ctx, restaurant, employee);
+    }
+  };
+
+  addEmployees(StaffScheduleKeynodes::concept_cook, 4, {morning, day});
+  addEmployees(StaffScheduleKeynodes::concept_waiter, 4, {morning, day, night});
+  addEmployees(StaffScheduleKeynodes::concept_cleaner, 2, {morning, day, night});
+  addEmployees(StaffScheduleKeynodes::concept_admin, 2, {day});
+
+  return restaurant;
+}
@@ -0,0 +1,231 @@
+#include "staff_schedule_builder.hpp"
+
+#include "solver/dinic_max_flow.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+void StaffScheduleBuilder::IndexDays()
+{
+  m_dayIndex.Clear();
+  for (auto & shift : m_shifts)
+    shift.dayIndex = shift.day.IsValid() ? m_dayIndex.Add(shift.day) : ScAddrIndex::NotFound;
+
+  size_t const dayCount = m_dayIndex.GetSize();
+  vector<size_t> nextDay(dayCount, ScAddrIndex::NotFound);
+  vector<char> hasPrevious(dayCount, 0);
+  for (auto const & shift : m_shifts)
+  {
+    if (shift.dayIndex == ScAddrIndex::NotFound)
+      continue;
+    size_t const next = m_dayIndex.Find(shift.nextDay);
+    if (next == ScAddrIndex::NotFound || next == shift.dayIndex)
+      continue;
+    nextDay[shift.dayIndex] = next;
+    hasPrevious[next] = 1;
+  }
+
+  // Дни цепочки идут подряд по 24 часа, после цепочки остаётся пустой день.
+  m_dayStartHour.assign(dayCount, ScAddrIndex::NotFound);
+  size_t hour = 0;
+  auto const placeChain = [&](size_t day) {
+    for (; day != ScAddrIndex::NotFound && m_dayStartHour[day] == ScAddrIndex::NotFound; day = nextDay[day])
+    {
+      m_dayStartHour[day] = hour;
+      hour += 24;
+    }
+    hour += 24;
+  };
+  for (size_t day = 0; day < dayCount; ++day)
+  {
+    if (!hasPrevious[day])
+      placeChain(day);
+  }
+
+  // Неделя повторяется, только если все дни замкнуты в одно кольцо.
+  m_weekHours = 0;
+  if (hour == 0 && dayCount != 0)
+  {
+    placeChain(0);
+    if (hour == 24 * (dayCount + 1))
+      m_weekHours = 24 * dayCount;
+  }
+  for (size_t day = 0; day < dayCount; ++day)
+  {
+    if (m_dayStartHour[day] == ScAddrIndex::NotFound)
+      placeChain(day);
+  }
+}
+
+size_t StaffScheduleBuilder::GetEntryNode(size_t employeeIndex, size_t shiftIndex) const
+{
+  size_t const dayIndex = m_shifts[shiftIndex].dayIndex;
+  if (m_employeeDayNode.empty() || dayIndex == ScAddrIndex::NotFound)
+    return employeeIndex;
+  size_t const dayNode = m_employeeDayNode[employeeIndex * m_dayIndex.GetSize() + dayIndex];
+  return dayNode == ScAddrIndex::NotFound ? employeeIndex : dayNode;
+}
+
+size_t StaffScheduleBuilder::GetNodeEmployee(size_t node) const
+{
+  if (node < m_demandStart)
+    return node;
+  if (node >= m_dayNodeStart)
+    return m_dayNodeEmployee[node - m_dayNodeStart];
+  return ScAddrIndex::NotFound;
+}
+
+bool StaffScheduleBuilder::HasDayLeft(size_t employeeIndex, size_t shiftIndex) const
+{
+  size_t const entryNode = GetEntryNode(employeeIndex, shiftIndex);
+  if (entryNode == employeeIndex)
+    return true;
+  return m_network.GetArc(m_network.GetEdgeArc(m_dayEdgeStart + entryNode - m_dayNodeStart)).cap > 0;
+}
+
+void StaffScheduleBuilder::ResolveRestConflicts()
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "rest_conflicts");
+
+  // Назначение сотрудника на оси времени недели; arc — дуга от сотрудника или его дня к потребности.
+  struct Placement
+  {
+    size_t start;
+    size_t end;
+    size_t demandIndex;
+    size_t arc;
+  };
+
+  // Смена, которая заканчивается не позже начала, переходит на следующий день.
+  size_t const demandCount = m_demands.size();
+  vector<pair<size_t, size_t>> demandHours(demandCount, {ShiftInfo::NoHour, ShiftInfo::NoHour});
+  for (size_t d = 0; d < demandCount; ++d)
+  {
+    ShiftInfo const & shift = m_shifts[m_demands[d].shiftIndex];
+    if (shift.dayIndex == ScAddrIndex::NotFound || shift.startHour == ShiftInfo::NoHour)
+      continue;
+    size_t const dayStart = m_dayStartHour[shift.dayIndex];
+    demandHours[d] = {
+        dayStart + shift.startHour, dayStart + shift.endHour + (shift.endHour <= shift.startHour ? 24 : 0)};
+  }
+
+  // Смены слишком близки, если между ними меньше часов отдыха; в повторяющейся неделе — и через её конец.
+  auto const isTooClose = [&](size_t start, size_t end, Placement const & other) {
+    auto const isClose = [&](size_t leftStart, size_t leftEnd, size_t rightStart, size_t rightEnd) {
+      return leftStart < rightEnd + m_minRestHours && rightStart < leftEnd + m_minRestHours;
+    };
+    return isClose(start, end, other.start, other.end)
+           || (m_weekHours != 0
+               && (isClose(start + m_weekHours, end + m_weekHours, other.start, other.end)
+                   || isClose(start, end, other.start + m_weekHours, other.end + m_weekHours)));
+  };
+
+  DinicMaxFlow solver;
+  vector<vector<Placement>> placements(m_employees.size());
+  vector<pair<size_t, Placement>> dropped;
+  vector<Placement> kept;
+  vector<size_t> entryNodes;
+  size_t rounds = 0;
+  size_t conflictCount = 0;
+  size_t forbiddenCount = 0;
+  while (true)
+  {
+    for (auto & employeePlacements : placements)
+      employeePlacements.clear();
+
+    for (size_t d = 0; d < demandCount; ++d)
+    {
+      auto const [start, end] = demandHours[d];
+      if (start == ShiftInfo::NoHour)
+        continue;
+      size_t const demandNode = m_demandStart + d;
+      for (size_t a = m_network.ArcsBegin(demandNode); a < m_network.ArcsEnd(demandNode); ++a)
+      {
+        FlowNetwork::Arc const & arc = m_network.GetArc(a);
+        size_t const employeeIndex = GetNodeEmployee(static_cast<size_t>(arc.to));
+        if (employeeIndex != ScAddrIndex::NotFound && arc.cap == 1)
+          placements[employeeIndex].push_back({start, end, d, static_cast<size_t>(arc.rev)});
+      }
+    }
+
+    // Смены сотрудника просматриваются по времени: смена, начавшаяся раньше конца отдыха после
+    // последней оставленной, снимается. В повторяющейся неделе последняя сравнивается и с первой.
+    dropped.clear();
+    for (size_t i = 0; i < placements.size(); ++i)
+    {
+      vector<Placement> & employeePlacements = placements[i];
+      if (employeePlacements.empty())
+        continue;
+      sort(employeePlacements.begin(), employeePlacements.end(), [](Placement const & left, Placement const & right) {
+        return left.start < right.start;
+      });
+
+      kept.assign(1, employeePlacements[0]);
+      for (size_t k = 1; k < employeePlacements.size(); ++k)
+      {
+        if (employeePlacements[k].start < kept.back().end + m_minRestHours)
+          dropped.push_back({i, employeePlacements[k]});
+        else
+          kept.push_back(employeePlacements[k]);
+      }
+      if (m_weekHours != 0 && kept.size() > 1 && kept[0].start + m_weekHours < kept.back().end + m_minRestHours)
+      {
+        dropped.push_back({i, kept.back()});
+        kept.pop_back();
+      }
+
+      // Свободные дуги к сменам рядом с оставленными закрываются: иначе повторный поиск потока
+      // снова назначил бы туда сотрудника и породил бы новый раунд.
+      entryNodes.assign(1, i);
+      for (size_t a = m_network.ArcsBegin(i); a < m_network.ArcsEnd(i); ++a)
+      {
+        if (static_cast<size_t>(m_network.GetArc(a).to) >= m_dayNodeStart)
+          entryNodes.push_back(static_cast<size_t>(m_network.GetArc(a).to));
+      }
+      for (size_t const node : entryNodes)
+      {
+        for (size_t a = m_network.ArcsBegin(node); a < m_network.ArcsEnd(node); ++a)
+        {
+          FlowNetwork::Arc & arc = m_network.GetArc(a);
+          size_t const to = static_cast<size_t>(arc.to);
+          if (arc.cap <= 0 || to < m_demandStart || to >= m_demandStart + demandCount)
+            continue;
+          auto const [start, end] = demandHours[to - m_demandStart];
+          if (start == ShiftInfo::NoHour)
+            continue;
+          if (any_of(kept.begin(), kept.end(), [&](Placement const & other) {
+                return isTooClose(start, end, other);
+              }))
+          {
+            arc.cap = 0;
+            ++forbiddenCount;
+          }
+        }
+      }
+    }
+    if (dropped.empty())
+      break;
+
+    // Единица потока возвращается по всему пути, а дуга назначения закрывается навсегда.
+    for (auto const & [employeeIndex, placement] : dropped)
+    {
+      size_t const entryNode = static_cast<size_t>(m_network.GetArc(m_network.GetArc(placement.arc).rev).to);
+      m_network.Push(placement.arc, -1);
+      m_network.GetArc(placement.arc).cap = 0;
+      m_network.Push(m_network.GetEdgeArc(employeeIndex), -1);
+      if (entryNode != employeeIndex)
+        m_network.Push(m_network.GetEdgeArc(m_dayEdgeStart + entryNode - m_dayNodeStart), -1);
+      m_network.Push(m_network.GetEdgeArc(m_sinkEdgeStart + placement.demandIndex), -1);
+    }
+    m_flow -= dropped.size();
+    conflictCount += dropped.size();
+    ++rounds;
+
+    m_flow += static_cast<size_t>(solver.Solve(m_network, m_source, m_sink));
+  }
+
+  m_metrics.AddCounter("rest_conflicts", conflictCount);
+  m_metrics.AddCounter("rest_forbidden_arcs", forbiddenCount);
+  m_metrics.AddCounter("rest_rounds", rounds);
+}
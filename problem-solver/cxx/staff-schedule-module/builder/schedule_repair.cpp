@@ -0,0 +1,457 @@
+#include "staff_schedule_builder.hpp"
+
+#include <sc-memory/sc_iterator.hpp>
+
+#include "builder/schedule_solver_class.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+size_t StaffScheduleBuilder::LoadSchedule(ScAddr const & scheduleAddr, bool restoreFlow)
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "load_schedule");
+  m_scheduleAddr = scheduleAddr;
+
+  LoadedSchedule & loaded = m_loadedSchedule;
+  loaded = LoadedSchedule();
+  loaded.hasShift.assign(m_shifts.size(), 0);
+  loaded.employeeSchedules.assign(m_employees.size(), ScAddr::Empty);
+  loaded.employeeScheduleArcs.assign(m_employees.size(), ScAddr::Empty);
+  loaded.shiftCountLinks.assign(m_employees.size(), ScAddr::Empty);
+  loaded.shiftCountArcs.assign(m_employees.size(), ScAddr::Empty);
+
+  ScIterator3Ptr itNodes = CreateIterator3(scheduleAddr, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (itNodes->Next())
+  {
+    ScAddr const & node = itNodes->Get(2);
+    size_t const shiftIndex = m_shiftIndex.Find(node);
+    if (shiftIndex != ScAddrIndex::NotFound)
+      loaded.hasShift[shiftIndex] = 1;
+    else if (m_context.CheckConnector(StaffScheduleKeynodes::concept_staffing_issue, node, ScType::ConstPermPosArc))
+      loaded.issues.push_back(node);
+    else if (!m_context.GetElementType(node).IsLink())
+      loaded.staleShiftArcs.push_back(itNodes->Get(1));
+  }
+
+  // Назначения, которые всё ещё допустимы, становятся начальным потоком сети;
+  // без восстановления потока достаточно того, что смена и сотрудник ещё есть.
+  size_t restored = 0;
+  ScIterator3Ptr itArcs = CreateIterator3(scheduleAddr, ScType::ConstPermPosArc, ScType::ConstCommonArc);
+  while (itArcs->Next())
+  {
+    ScAddr const & arc = itArcs->Get(2);
+    auto const [source, target] = m_context.GetConnectorIncidentElements(arc);
+    if (m_context.CheckConnector(StaffScheduleKeynodes::nrel_assigned_employee, arc, ScType::ConstPermPosArc))
+    {
+      LoadedAssignment assignment{arc, m_shiftIndex.Find(source), m_employeeIndex.Find(target), false};
+      if (assignment.shiftIndex != ScAddrIndex::NotFound && assignment.employeeIndex != ScAddrIndex::NotFound)
+        assignment.valid = !restoreFlow || RestoreAssignment(assignment.shiftIndex, assignment.employeeIndex);
+      restored += assignment.valid ? 1 : 0;
+      loaded.assignments.push_back(assignment);
+    }
+    else if (m_context.CheckConnector(StaffScheduleKeynodes::nrel_reserve_employee, arc, ScType::ConstPermPosArc))
+    {
+      loaded.reserves.push_back({arc, m_shiftIndex.Find(source), m_employeeIndex.Find(target), false});
+    }
+    else
+    {
+      // Расписание и счётчик смен ушедшего сотрудника удаляются вместе с его назначениями.
+      size_t const employeeIndex = m_employeeIndex.Find(source);
+      if (employeeIndex == ScAddrIndex::NotFound)
+      {
+        if (m_context.CheckConnector(StaffScheduleKeynodes::nrel_employee_schedule, arc, ScType::ConstPermPosArc)
+            || m_context.CheckConnector(StaffScheduleKeynodes::nrel_shift_count, arc, ScType::ConstPermPosArc))
+          loaded.staleEmployeeElements.push_back(target);
+        continue;
+      }
+      if (m_context.CheckConnector(StaffScheduleKeynodes::nrel_employee_schedule, arc, ScType::ConstPermPosArc))
+      {
+        loaded.employeeSchedules[employeeIndex] = target;
+        loaded.employeeScheduleArcs[employeeIndex] = arc;
+      }
+      else if (m_context.CheckConnector(StaffScheduleKeynodes::nrel_shift_count, arc, ScType::ConstPermPosArc))
+      {
+        loaded.shiftCountLinks[employeeIndex] = target;
+        loaded.shiftCountArcs[employeeIndex] = arc;
+      }
+    }
+  }
+
+  ScIterator5Ptr itStaffed = CreateIterator5(
+      scheduleAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_all_shifts_staffed);
+  if (itStaffed->Next())
+    loaded.staffedLink = itStaffed->Get(2);
+
+  ScIterator5Ptr itDeviation = CreateIterator5(
+      scheduleAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_shift_count_deviation);
+  if (itDeviation->Next())
+    loaded.deviationLink = itDeviation->Get(2);
+
+  ScIterator5Ptr itSolver = CreateIterator5(
+      scheduleAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeClass,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_schedule_solver);
+  if (itSolver->Next())
+  {
+    loaded.solverArc = itSolver->Get(1);
+    loaded.solverType = GetScheduleSolverType(m_context, m_logger, itSolver->Get(2));
+  }
+
+  if (!restoreFlow)
+    return restored;
+
+  m_flow = restored;
+  m_metrics.AddCounter("assignments_restored", restored);
+  return restored;
+}
+
+ScAddr StaffScheduleBuilder::FindCurrentSchedule()
+{
+  ScIterator5Ptr itCurrent = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  while (itCurrent->Next())
+  {
+    ScAddr const & schedule = itCurrent->Get(2);
+    if (m_context.CheckConnector(StaffScheduleKeynodes::concept_week_schedule, schedule, ScType::ConstPermPosArc))
+      return schedule;
+  }
+  return ScAddr::Empty;
+}
+
+ScStructure StaffScheduleBuilder::UpdateSchedule()
+{
+  ScAddr const scheduleAddr = FindCurrentSchedule();
+  if (!scheduleAddr.IsValid())
+    return WriteSchedule();
+
+  // Поток уже найден заново, прежний график нужен только для сравнения назначений.
+  size_t const loaded = LoadSchedule(scheduleAddr, false);
+  m_metrics.AddCounter("assignments_loaded", loaded);
+  return RepairSchedule();
+}
+
+ScheduleSolverType StaffScheduleBuilder::GetLoadedSolverType() const
+{
+  return m_loadedSchedule.solverType;
+}
+
+bool StaffScheduleBuilder::RestoreAssignment(size_t shiftIndex, size_t employeeIndex)
+{
+  EmployeeInfo const & employee = m_employees[employeeIndex];
+  size_t demandIndex = ScAddrIndex::NotFound;
+  for (size_t d = m_shiftDemandStart[shiftIndex]; d < m_shiftDemandStart[shiftIndex + 1]; ++d)
+  {
+    if (m_demands[d].role == employee.role)
+    {
+      demandIndex = d;
+      break;
+    }
+  }
+  if (demandIndex == ScAddrIndex::NotFound)
+    return false;
+
+  // Единичная дуга к потребности есть, только если сотрудник доступен; повторное назначение её не найдёт.
+  size_t const demandNode = m_demandStart + demandIndex;
+  size_t const entryNode = GetEntryNode(employeeIndex, shiftIndex);
+  size_t employeeArc = ScAddrIndex::NotFound;
+  for (size_t a = m_network.ArcsBegin(entryNode); a < m_network.ArcsEnd(entryNode); ++a)
+  {
+    FlowNetwork::Arc const & arc = m_network.GetArc(a);
+    if (static_cast<size_t>(arc.to) == demandNode && arc.cap == 1)
+    {
+      employeeArc = a;
+      break;
+    }
+  }
+  if (employeeArc == ScAddrIndex::NotFound)
+    return false;
+
+  // Лимит смен сотрудника и число мест в потребности могли уменьшиться.
+  size_t const sourceArc = m_network.GetEdgeArc(employeeIndex);
+  size_t const sinkArc = m_network.GetEdgeArc(m_sinkEdgeStart + demandIndex);
+  if (m_network.GetArc(sourceArc).cap <= 0 || m_network.GetArc(sinkArc).cap <= 0
+      || !HasDayLeft(employeeIndex, shiftIndex))
+    return false;
+
+  m_network.Push(sourceArc, 1);
+  if (entryNode != employeeIndex)
+    m_network.Push(m_network.GetEdgeArc(m_dayEdgeStart + entryNode - m_dayNodeStart), 1);
+  m_network.Push(employeeArc, 1);
+  m_network.Push(sinkArc, 1);
+  return true;
+}
+
+ScStructure StaffScheduleBuilder::RepairSchedule()
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "repair_schedule");
+
+  LoadedSchedule & loaded = m_loadedSchedule;
+  size_t const employeeCount = m_employees.size();
+  auto const pairKey = [employeeCount](size_t shiftIndex, size_t employeeIndex) {
+    return shiftIndex * employeeCount + employeeIndex;
+  };
+
+  vector<vector<size_t>> assignedPerDemand = CollectAssignments();
+  if (m_substituteCount != 0)
+    SearchAlternatingPaths();
+  unordered_set<size_t> assignedPairs;
+  for (size_t d = 0; d < m_demands.size(); ++d)
+  {
+    for (size_t employeeIndex : assignedPerDemand[d])
+      assignedPairs.insert(pairKey(m_demands[d].shiftIndex, employeeIndex));
+  }
+
+  // Результат содержит весь график, как и после записи нового: сохранённые элементы входят в него наравне
+  // с созданными.
+  ScheduleResultWriter writer(m_context);
+  ElementId const schedule = writer.AddExisting(m_scheduleAddr, true);
+  writer.AddExisting(m_restaurantAddr, true);
+  ScIterator5Ptr itCurrent = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      m_scheduleAddr,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  if (itCurrent->Next())
+    writer.AddExisting(itCurrent->Get(1), true);
+
+  vector<ElementId> shiftIds;
+  shiftIds.reserve(m_shifts.size());
+  for (auto const & shift : m_shifts)
+    shiftIds.push_back(writer.AddExisting(shift.addr, true));
+  vector<ElementId> employeeIds;
+  employeeIds.reserve(employeeCount);
+  for (auto const & employee : m_employees)
+    employeeIds.push_back(writer.AddExisting(employee.addr, true));
+
+  vector<char> changedShift(m_shifts.size(), 0);
+  vector<char> changedEmployee(employeeCount, 0);
+  auto const markChanged = [&](size_t shiftIndex, size_t employeeIndex) {
+    if (shiftIndex != ScAddrIndex::NotFound)
+      changedShift[shiftIndex] = 1;
+    if (employeeIndex != ScAddrIndex::NotFound)
+      changedEmployee[employeeIndex] = 1;
+  };
+
+  // Сохранённые назначения остаются на месте, остальные удаляются. Замены зависят от всей
+  // остаточной сети, поэтому прежние замены удаляются у всех назначений.
+  unordered_map<size_t, ScAddr> keptArcs;
+  size_t removedCount = 0;
+  for (auto const & assignment : loaded.assignments)
+  {
+    EraseSubstitutes(assignment.arc);
+    if (assignment.valid)
+    {
+      size_t const key = pairKey(assignment.shiftIndex, assignment.employeeIndex);
+      if (assignedPairs.count(key) != 0 && keptArcs.emplace(key, assignment.arc).second)
+        continue;
+    }
+    m_context.EraseElement(assignment.arc);
+    markChanged(assignment.shiftIndex, assignment.employeeIndex);
+    ++removedCount;
+  }
+
+  size_t addedCount = 0;
+  size_t substituteCount = 0;
+  for (size_t d = 0; d < m_demands.size(); ++d)
+  {
+    size_t const shiftIndex = m_demands[d].shiftIndex;
+    for (size_t employeeIndex : assignedPerDemand[d])
+    {
+      ElementId assignedArc;
+      auto const kept = keptArcs.find(pairKey(shiftIndex, employeeIndex));
+      if (kept != keptArcs.end())
+      {
+        assignedArc = writer.AddExisting(kept->second, true);
+      }
+      else
+      {
+        assignedArc = writer.AddRelation(
+            shiftIds[shiftIndex], employeeIds[employeeIndex], StaffScheduleKeynodes::nrel_assigned_employee, true);
+        writer.AddConnector(ScType::ConstPermPosArc, schedule, assignedArc);
+        markChanged(shiftIndex, employeeIndex);
+        ++addedCount;
+      }
+      if (m_substituteCount != 0)
+        substituteCount += AddSubstitutes(writer, assignedArc, d, employeeIndex, shiftIds, employeeIds);
+    }
+  }
+
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+  {
+    if (loaded.hasShift[j])
+      continue;
+    writer.AddConnector(ScType::ConstPermPosArc, schedule, shiftIds[j]);
+    changedShift[j] = 1;
+  }
+  for (auto const & arc : loaded.staleShiftArcs)
+    m_context.EraseElement(arc);
+
+  // Проблемы укомплектования зависят только от назначений смены, их переписываем для изменённых смен.
+  for (auto const & issue : loaded.issues)
+  {
+    ScIterator5Ptr itShift = CreateIterator5(
+        issue,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_missing_shift);
+    size_t const shiftIndex = itShift->Next() ? m_shiftIndex.Find(itShift->Get(2)) : ScAddrIndex::NotFound;
+    if (shiftIndex != ScAddrIndex::NotFound && !changedShift[shiftIndex])
+    {
+      writer.AddExisting(issue, true);
+      continue;
+    }
+
+    ScIterator5Ptr itCount = CreateIterator5(
+        issue,
+        ScType::ConstCommonArc,
+        ScType::ConstNodeLink,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_missing_count);
+    if (itCount->Next())
+      m_context.EraseElement(itCount->Get(2));
+    m_context.EraseElement(issue);
+  }
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+  {
+    if (changedShift[j])
+      AddStaffingIssues(writer, schedule, shiftIds[j], j, assignedPerDemand);
+  }
+
+  // Резерв мог стать назначенным, недоступным или исчерпать лимит и без изменения смены,
+  // поэтому сверяем все резервы.
+  for (auto & reserve : loaded.reserves)
+  {
+    if (reserve.shiftIndex == ScAddrIndex::NotFound || changedShift[reserve.shiftIndex])
+      continue;
+    if (reserve.employeeIndex == ScAddrIndex::NotFound)
+    {
+      changedShift[reserve.shiftIndex] = 1;
+      continue;
+    }
+    EmployeeBitset const * candidates =
+        FindCandidates(m_employees[reserve.employeeIndex].role, m_shifts[reserve.shiftIndex].shiftTypeIndex);
+    reserve.valid = m_reserveCount != 0 && candidates != nullptr && candidates->Test(reserve.employeeIndex)
+                    && GetShiftsLeft(reserve.employeeIndex) != 0
+                    && HasDayLeft(reserve.employeeIndex, reserve.shiftIndex)
+                    && assignedPairs.count(pairKey(reserve.shiftIndex, reserve.employeeIndex)) == 0;
+    if (!reserve.valid)
+      changedShift[reserve.shiftIndex] = 1;
+  }
+  for (auto const & reserve : loaded.reserves)
+  {
+    if (reserve.shiftIndex == ScAddrIndex::NotFound || changedShift[reserve.shiftIndex])
+      m_context.EraseElement(reserve.arc);
+    else
+      writer.AddExisting(reserve.arc, true);
+  }
+  size_t reserveCount = 0;
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+  {
+    if (changedShift[j])
+      reserveCount += AddReserves(writer, schedule, shiftIds[j], employeeIds, j, assignedPerDemand);
+  }
+
+  for (auto const & element : loaded.staleEmployeeElements)
+    m_context.EraseElement(element);
+  for (size_t i = 0; i < employeeCount; ++i)
+  {
+    ScAddr const & employeeSchedule = loaded.employeeSchedules[i];
+    ScAddr const & countLink = loaded.shiftCountLinks[i];
+    if (!employeeSchedule.IsValid() || !countLink.IsValid())
+    {
+      AddEmployeeSchedule(writer, schedule, employeeIds[i], shiftIds, i);
+      continue;
+    }
+    writer.AddExisting(loaded.employeeScheduleArcs[i], true);
+    writer.AddExisting(loaded.shiftCountArcs[i], true);
+    if (!changedEmployee[i])
+      continue;
+
+    m_context.SetLinkContent(countLink, to_string(m_employees[i].assignedCount));
+
+    unordered_set<ScAddr, ScAddrHashFunc> assignedShifts(
+        m_employees[i].assignedShifts.begin(), m_employees[i].assignedShifts.end());
+    vector<ScAddr> staleArcs;
+    ScIterator3Ptr itShifts = CreateIterator3(employeeSchedule, ScType::ConstPermPosArc, ScType::ConstNode);
+    while (itShifts->Next())
+    {
+      if (assignedShifts.erase(itShifts->Get(2)) == 0)
+        staleArcs.push_back(itShifts->Get(1));
+    }
+    for (auto const & arc : staleArcs)
+      m_context.EraseElement(arc);
+    ElementId const employeeScheduleId = writer.AddExisting(employeeSchedule);
+    for (auto const & shiftAddr : assignedShifts)
+      writer.AddConnector(ScType::ConstPermPosArc, employeeScheduleId, shiftIds[m_shiftIndex.Find(shiftAddr)]);
+  }
+
+  UpdateScheduleLink(
+      writer,
+      schedule,
+      loaded.staffedLink,
+      StaffScheduleKeynodes::nrel_all_shifts_staffed,
+      m_flow == m_slotCount ? "true" : "false");
+  UpdateScheduleLink(
+      writer,
+      schedule,
+      loaded.deviationLink,
+      StaffScheduleKeynodes::nrel_shift_count_deviation,
+      GetShiftCountDeviation());
+
+  // Обновление на месте может идти другим решателем, чем тот, что построил график.
+  if (!loaded.solverArc.IsValid() || loaded.solverType != m_solverType)
+  {
+    if (loaded.solverArc.IsValid())
+      m_context.EraseElement(loaded.solverArc);
+    ElementId const solverClass = writer.AddExisting(GetScheduleSolverClass(m_solverType));
+    writer.AddRelation(schedule, solverClass, StaffScheduleKeynodes::nrel_schedule_solver);
+  }
+
+  ScStructure result = writer.Commit();
+  m_metrics.AddElements(writer.GetGeneratedCount());
+  m_metrics.AddCounter("assignments_removed", removedCount);
+  m_metrics.AddCounter("assignments_added", addedCount);
+  m_metrics.AddCounter("reserves_added", reserveCount);
+  m_metrics.AddCounter("substitutes", substituteCount);
+  return result;
+}
+
+void StaffScheduleBuilder::UpdateScheduleLink(
+    ScheduleResultWriter & writer,
+    ElementId schedule,
+    ScAddr const & link,
+    ScAddr const & relation,
+    string const & content)
+{
+  if (!link.IsValid())
+  {
+    writer.AddRelation(schedule, writer.AddLink(content, true), relation);
+    return;
+  }
+  writer.AddExisting(link, true);
+
+  string previous;
+  m_context.GetLinkContent(link, previous);
+  if (previous != content)
+    m_context.SetLinkContent(link, content);
+}
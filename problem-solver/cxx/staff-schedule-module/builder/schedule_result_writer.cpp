@@ -0,0 +1,145 @@
+#include "schedule_result_writer.hpp"
+
+using namespace std;
+
+namespace
+{
+class EventsPendingGuard
+{
+public:
+  explicit EventsPendingGuard(ScMemoryContext & context)
+    : m_context(context)
+  {
+    m_context.BeginEventsPending();
+  }
+
+  ~EventsPendingGuard()
+  {
+    m_context.EndEventsPending();
+  }
+
+private:
+  ScMemoryContext & m_context;
+};
+}  // namespace
+
+ScheduleResultWriter::ScheduleResultWriter(ScMemoryContext & context)
+  : m_context(context)
+{
+}
+
+ScheduleResultWriter::ElementId ScheduleResultWriter::AddExisting(ScAddr const & addr, bool inResult)
+{
+  auto const it = m_existingIds.find(addr);
+  if (it != m_existingIds.end())
+  {
+    m_elements[it->second].inResult |= inResult;
+    return it->second;
+  }
+
+  Element element{Kind::Existing, ScType::Unknown, addr};
+  element.inResult = inResult;
+  ElementId const id = Add(element);
+  m_existingIds.emplace(addr, id);
+  return id;
+}
+
+ScheduleResultWriter::ElementId ScheduleResultWriter::AddNode(ScType const & type, bool inResult)
+{
+  Element element{Kind::Node, type, ScAddr::Empty};
+  element.inResult = inResult;
+  return Add(element);
+}
+
+ScheduleResultWriter::ElementId ScheduleResultWriter::AddLink(string const & content, bool inResult)
+{
+  Element element{Kind::Link, ScType::ConstNodeLink, ScAddr::Empty};
+  element.contentIndex = m_contents.size();
+  element.inResult = inResult;
+  m_contents.push_back(content);
+  return Add(element);
+}
+
+ScheduleResultWriter::ElementId ScheduleResultWriter::AddConnector(
+    ScType const & type,
+    ElementId source,
+    ElementId target,
+    bool inResult)
+{
+  Element element{Kind::Connector, type, ScAddr::Empty};
+  element.source = source;
+  element.target = target;
+  element.inResult = inResult;
+  return Add(element);
+}
+
+ScheduleResultWriter::ElementId ScheduleResultWriter::AddRelation(
+    ElementId source,
+    ElementId target,
+    ScAddr const & relation,
+    bool inResult)
+{
+  ElementId const arc = AddConnector(ScType::ConstCommonArc, source, target, inResult);
+  AddConnector(ScType::ConstPermPosArc, AddExisting(relation), arc);
+  return arc;
+}
+
+void ScheduleResultWriter::AddToClass(ScAddr const & classAddr, ElementId element)
+{
+  AddConnector(ScType::ConstPermPosArc, AddExisting(classAddr), element);
+}
+
+ScStructure ScheduleResultWriter::Commit()
+{
+  // Все элементы создаются подряд, события sc-памяти откладываются до конца записи.
+  EventsPendingGuard guard(m_context);
+
+  ScStructure result = m_context.GenerateStructure();
+  m_generatedCount = 1;
+  for (auto & element : m_elements)
+  {
+    switch (element.kind)
+    {
+    case Kind::Existing:
+      break;
+    case Kind::Node:
+      element.addr = m_context.GenerateNode(element.type);
+      ++m_generatedCount;
+      break;
+    case Kind::Link:
+      element.addr = m_context.GenerateLink(element.type);
+      m_context.SetLinkContent(element.addr, m_contents[element.contentIndex]);
+      ++m_generatedCount;
+      break;
+    case Kind::Connector:
+      element.addr =
+          m_context.GenerateConnector(element.type, m_elements[element.source].addr, m_elements[element.target].addr);
+      ++m_generatedCount;
+      break;
+    }
+
+    // Элементы создаются впервые, поэтому проверять их наличие в структуре не нужно.
+    if (element.inResult)
+    {
+      m_context.GenerateConnector(ScType::ConstPermPosArc, result, element.addr);
+      ++m_generatedCount;
+    }
+  }
+  return result;
+}
+
+ScAddr ScheduleResultWriter::GetAddr(ElementId element) const
+{
+  return m_elements[element].addr;
+}
+
+size_t ScheduleResultWriter::GetGeneratedCount() const
+{
+  return m_generatedCount;
+}
+
+ScheduleResultWriter::ElementId ScheduleResultWriter::Add(Element const & element)
+{
+  m_elements.push_back(element);
+  return m_elements.size() - 1;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * Buffers output of schedule writing and generates it in one pass with events pending,
+ * adding elements marked for the result to the structure in the same pass.
+ * Elements are referred to by local ids until Commit; real addresses are known after it.
+ */
+class ScheduleResultWriter
+{
+public:
+  using ElementId = size_t;
+
+  explicit ScheduleResultWriter(ScMemoryContext & context);
+
+  //! Refers to an element that already exists in sc-memory; the same address always gets the same id.
+  ElementId AddExisting(ScAddr const & addr, bool inResult = false);
+  ElementId AddNode(ScType const & type, bool inResult = false);
+  ElementId AddLink(std::string const & content, bool inResult = false);
+  ElementId AddConnector(ScType const & type, ElementId source, ElementId target, bool inResult = false);
+
+  //! Adds source => relation: target as a common arc with a membership arc; returns the common arc.
+  ElementId AddRelation(ElementId source, ElementId target, ScAddr const & relation, bool inResult = false);
+
+  //! Adds element to the class as a membership arc.
+  void AddToClass(ScAddr const & classAddr, ElementId element);
+
+  //! Generates all buffered elements and returns the result structure.
+  ScStructure Commit();
+
+  //! Address of the element; for generated elements available only after Commit.
+  ScAddr GetAddr(ElementId element) const;
+
+  //! Number of elements generated by Commit, including the structure and its arcs.
+  size_t GetGeneratedCount() const;
+
+private:
+  enum class Kind
+  {
+    Existing,
+    Node,
+    Link,
+    Connector
+  };
+
+  struct Element
+  {
+    Kind kind;
+    ScType type;
+    ScAddr addr;
+    ElementId source = 0;
+    ElementId target = 0;
+    size_t contentIndex = 0;
+    bool inResult = false;
+  };
+
+  ElementId Add(Element const & element);
+
+  ScMemoryContext & m_context;
+  std::vector<Element> m_elements;
+  std::vector<std::string> m_contents;
+  std::unordered_map<ScAddr, ElementId, ScAddrHashFunc> m_existingIds;
+  size_t m_generatedCount = 0;
+};
@@ -0,0 +1,50 @@
+#include "schedule_solver_class.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+// Адреса ключевых узлов известны только после инициализации памяти, поэтому список не кешируется.
+vector<pair<ScAddr, ScheduleSolverType>> GetSolverClasses()
+{
+  return {
+      {StaffScheduleKeynodes::concept_solver_dinic, ScheduleSolverType::Dinic},
+      {StaffScheduleKeynodes::concept_solver_hopcroft_karp, ScheduleSolverType::HopcroftKarp},
+      {StaffScheduleKeynodes::concept_solver_push_relabel, ScheduleSolverType::PushRelabel},
+      {StaffScheduleKeynodes::concept_solver_decomposed, ScheduleSolverType::Decomposed},
+      {StaffScheduleKeynodes::concept_solver_min_cost, ScheduleSolverType::MinCost},
+      {StaffScheduleKeynodes::concept_solver_preference, ScheduleSolverType::Preference}};
+}
+}  // namespace
+
+ScheduleSolverType GetScheduleSolverType(
+    ScMemoryContext & context,
+    utils::ScLogger & logger,
+    ScAddr const & solverAddr)
+{
+  if (!context.IsElement(solverAddr))
+    return ScheduleSolverType::Dinic;
+
+  for (auto const & [solverClass, type] : GetSolverClasses())
+  {
+    if (solverAddr == solverClass || context.CheckConnector(solverClass, solverAddr, ScType::ConstPermPosArc))
+      return type;
+  }
+
+  logger.Warning("Unknown solver, Dinic is used");
+  return ScheduleSolverType::Dinic;
+}
+
+ScAddr GetScheduleSolverClass(ScheduleSolverType type)
+{
+  for (auto const & [solverClass, solverType] : GetSolverClasses())
+  {
+    if (solverType == type)
+      return solverClass;
+  }
+  return StaffScheduleKeynodes::concept_solver_dinic;
+}
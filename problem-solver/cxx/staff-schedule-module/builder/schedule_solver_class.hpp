@@ -0,0 +1,15 @@
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/utils/sc_logger.hpp>
+
+#include "solver/schedule_solver.hpp"
+
+//! Solver is given by its class (concept_solver_*) or by an element of that class; Dinic if not given.
+ScheduleSolverType GetScheduleSolverType(
+    ScMemoryContext & context,
+    utils::ScLogger & logger,
+    ScAddr const & solverAddr);
+
+//! Class of the solver (concept_solver_*) that GetScheduleSolverType maps to the type.
+ScAddr GetScheduleSolverClass(ScheduleSolverType type);
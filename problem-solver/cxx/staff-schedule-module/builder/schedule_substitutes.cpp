@@ -0,0 +1,185 @@
+#include "staff_schedule_builder.hpp"
+
+#include <sc-memory/sc_iterator.hpp>
+#include <sc-memory/sc_keynodes.hpp>
+
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+using namespace std;
+
+void StaffScheduleBuilder::SearchAlternatingPaths()
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "alternating_paths");
+
+  size_t const nodeCount = m_network.GetNodeCount();
+  m_pathParent.assign(nodeCount, ScAddrIndex::NotFound);
+  m_pathEmployees.assign(nodeCount, 0);
+  vector<size_t> pathStart(nodeCount, ScAddrIndex::NotFound);
+  vector<size_t> queue;
+  queue.reserve(nodeCount);
+
+  // Сотрудник с запасом смен достижим сразу. Дальше путь чередует свободные дуги к потребностям
+  // и обратные дуги назначений: сотрудник берёт смену, которую освобождает следующий за ним.
+  for (size_t a = m_network.ArcsBegin(m_source); a < m_network.ArcsEnd(m_source); ++a)
+  {
+    FlowNetwork::Arc const & arc = m_network.GetArc(a);
+    if (arc.cap <= 0)
+      continue;
+    size_t const employeeIndex = static_cast<size_t>(arc.to);
+    m_pathParent[employeeIndex] = m_source;
+    m_pathEmployees[employeeIndex] = 1;
+    pathStart[employeeIndex] = employeeIndex;
+    queue.push_back(employeeIndex);
+  }
+
+  // Переходы между сотрудником и его днями не меняют числа сотрудников на пути, переход из потребности
+  // добавляет того, кто её освобождает.
+  for (size_t head = 0; head < queue.size(); ++head)
+  {
+    size_t const node = queue[head];
+    for (size_t a = m_network.ArcsBegin(node); a < m_network.ArcsEnd(node); ++a)
+    {
+      FlowNetwork::Arc const & arc = m_network.GetArc(a);
+      size_t const to = static_cast<size_t>(arc.to);
+      if (arc.cap <= 0 || to == m_source || to == m_sink || m_pathParent[to] != ScAddrIndex::NotFound)
+        continue;
+
+      m_pathParent[to] = node;
+      if (GetNodeEmployee(to) != ScAddrIndex::NotFound)
+      {
+        bool const fromDemand = GetNodeEmployee(node) == ScAddrIndex::NotFound;
+        size_t const previous = fromDemand ? m_pathParent[node] : node;
+        m_pathEmployees[to] = m_pathEmployees[previous] + (fromDemand ? 1 : 0);
+        pathStart[to] = pathStart[previous];
+      }
+      queue.push_back(to);
+    }
+  }
+
+  // Порядок замен не зависит от потребности, поэтому достижимые вершины сотрудников ранжируются один раз.
+  m_rankedNodes.clear();
+  for (size_t node = 0; node < nodeCount; ++node)
+  {
+    if (m_pathEmployees[node] != 0)
+      m_rankedNodes.push_back(node);
+  }
+  sort(m_rankedNodes.begin(), m_rankedNodes.end(), [&](size_t left, size_t right) {
+    return make_tuple(m_pathEmployees[left], GetShiftsLeft(pathStart[right]), GetNodeEmployee(left))
+           < make_tuple(m_pathEmployees[right], GetShiftsLeft(pathStart[left]), GetNodeEmployee(right));
+  });
+  vector<size_t> rank(nodeCount, ScAddrIndex::NotFound);
+  for (size_t r = 0; r < m_rankedNodes.size(); ++r)
+    rank[m_rankedNodes[r]] = r;
+
+  // Прямая дуга к потребности с остаточной ёмкостью означает, что кандидат не назначен на неё
+  // и назначение не запрещено.
+  m_substituteCandidates.assign(m_demands.size(), EmployeeBitset(m_rankedNodes.size()));
+  for (size_t d = 0; d < m_demands.size(); ++d)
+  {
+    size_t const demandNode = m_demandStart + d;
+    for (size_t a = m_network.ArcsBegin(demandNode); a < m_network.ArcsEnd(demandNode); ++a)
+    {
+      FlowNetwork::Arc const & arc = m_network.GetArc(a);
+      size_t const node = static_cast<size_t>(arc.to);
+      if (GetNodeEmployee(node) != ScAddrIndex::NotFound && m_network.GetArc(static_cast<size_t>(arc.rev)).cap > 0
+          && rank[node] != ScAddrIndex::NotFound)
+        m_substituteCandidates[d].Set(rank[node]);
+    }
+  }
+}
+
+vector<size_t> StaffScheduleBuilder::FindSubstitutes(size_t demandIndex, size_t employeeIndex) const
+{
+  // Путь замены не должен проходить через выбывшего сотрудника и его же смену.
+  size_t const demandNode = m_demandStart + demandIndex;
+  vector<size_t> substitutes;
+  m_substituteCandidates[demandIndex].ForEach([&](size_t rank) {
+    if (substitutes.size() == m_substituteCount)
+      return;
+    size_t const candidate = m_rankedNodes[rank];
+    bool avoids = true;
+    for (size_t node = candidate; node != m_source && avoids; node = m_pathParent[node])
+      avoids = GetNodeEmployee(node) != employeeIndex && node != demandNode;
+    if (avoids)
+      substitutes.push_back(candidate);
+  });
+  return substitutes;
+}
+
+size_t StaffScheduleBuilder::AddSubstitutes(
+    ScheduleResultWriter & writer,
+    ElementId assignedArc,
+    size_t demandIndex,
+    size_t employeeIndex,
+    vector<ElementId> const & shiftIds,
+    vector<ElementId> const & employeeIds)
+{
+  vector<size_t> const substitutes = FindSubstitutes(demandIndex, employeeIndex);
+  if (substitutes.empty())
+    return 0;
+
+  ElementId const list = writer.AddNode(ScType::ConstNodeTuple);
+  writer.AddRelation(assignedArc, list, StaffScheduleKeynodes::nrel_substitutes);
+  for (size_t rank = 0; rank < substitutes.size(); ++rank)
+  {
+    size_t const substitute = GetNodeEmployee(substitutes[rank]);
+    ElementId const substitution = writer.AddNode(ScType::ConstNode);
+    writer.AddToClass(StaffScheduleKeynodes::concept_substitution, substitution);
+    ElementId const listArc = writer.AddConnector(ScType::ConstPermPosArc, list, substitution);
+    writer.AddConnector(ScType::ConstPermPosArc, writer.AddExisting(ScKeynodes::GetRrelIndex(rank + 1)), listArc);
+    writer.AddRelation(substitution, employeeIds[substitute], StaffScheduleKeynodes::nrel_substitute);
+
+    // Замена берёт освободившуюся смену, каждый следующий сотрудник пути — смену, которую освободил предыдущий.
+    // Вершины одного сотрудника и его дней идут на пути подряд, между ними лежат потребности.
+    size_t toShift = m_demands[demandIndex].shiftIndex;
+    for (size_t node = substitutes[rank]; node != m_source;)
+    {
+      size_t const movedEmployee = GetNodeEmployee(node);
+      ElementId const move = writer.AddNode(ScType::ConstNode);
+      writer.AddConnector(ScType::ConstPermPosArc, substitution, move);
+      writer.AddRelation(move, employeeIds[movedEmployee], StaffScheduleKeynodes::nrel_moved_employee);
+      writer.AddRelation(move, shiftIds[toShift], StaffScheduleKeynodes::nrel_to_shift);
+
+      size_t parent = m_pathParent[node];
+      while (parent != m_source && GetNodeEmployee(parent) == movedEmployee)
+        parent = m_pathParent[parent];
+      if (parent == m_source)
+        break;
+      size_t const fromShift = m_demands[parent - m_demandStart].shiftIndex;
+      writer.AddRelation(move, shiftIds[fromShift], StaffScheduleKeynodes::nrel_from_shift);
+      toShift = fromShift;
+      node = m_pathParent[parent];
+    }
+  }
+  return substitutes.size();
+}
+
+void StaffScheduleBuilder::EraseSubstitutes(ScAddr const & assignedArc)
+{
+  vector<ScAddr> elements;
+  ScIterator5Ptr itList = CreateIterator5(
+      assignedArc,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeTuple,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_substitutes);
+  while (itList->Next())
+  {
+    elements.push_back(itList->Get(2));
+    ScIterator3Ptr itSubstitution = CreateIterator3(itList->Get(2), ScType::ConstPermPosArc, ScType::ConstNode);
+    while (itSubstitution->Next())
+    {
+      elements.push_back(itSubstitution->Get(2));
+      ScIterator3Ptr itMove = CreateIterator3(itSubstitution->Get(2), ScType::ConstPermPosArc, ScType::ConstNode);
+      while (itMove->Next())
+        elements.push_back(itMove->Get(2));
+    }
+  }
+
+  // Вместе с узлами удаляются и все их дуги.
+  for (auto const & element : elements)
+    m_context.EraseElement(element);
+}
@@ -0,0 +1,1264 @@
+#include "staff_schedule_builder.hpp"
+
+#include <sc-memory/sc_iterator.hpp>
+#include <sc-memory/sc_keynodes.hpp>
+
+#include "builder/schedule_result_writer.hpp"
+#include "builder/schedule_solver_class.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "solver/decomposed_max_flow.hpp"
+#include "solver/weighted_max_flow.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+StaffScheduleBuilder::StaffScheduleBuilder(ScMemoryContext & context, utils::ScLogger & logger)
+  : m_context(context)
+  , m_logger(logger)
+{
+}
+
+void StaffScheduleBuilder::ReadStaffData(ScAddr const & restaurantAddr, StaffDataReadMode mode)
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "read_staff_data");
+  m_restaurantAddr = restaurantAddr;
+
+  // Собираем типы смен один раз, чтобы использовать при проверке доступности.
+  vector<ScAddr> allShiftTypes;
+  ScIterator3Ptr itShiftTypes = CreateIterator3(
+      StaffScheduleKeynodes::concept_shift_type,
+      ScType::ConstPermPosArc,
+      ScType::ConstNode);
+  while (itShiftTypes->Next())
+  {
+    allShiftTypes.push_back(itShiftTypes->Get(2));
+  }
+
+  if (mode == StaffDataReadMode::PerEntity)
+    ReadStaffPerEntity(allShiftTypes);
+  else
+    ReadStaffByRelations(allShiftTypes);
+  ReadShifts();
+  ReadRequirements();
+
+  IndexStaffData();
+}
+
+void StaffScheduleBuilder::UseStaffData(ScAddr const & restaurantAddr, StaffData const & data)
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "read_staff_data");
+  m_metrics.AddCounter("cache_hit");
+  m_restaurantAddr = restaurantAddr;
+  m_employees = data.employees;
+  m_shifts = data.shifts;
+  IndexStaffData();
+}
+
+void StaffScheduleBuilder::ReadStaffPerEntity(vector<ScAddr> const & allShiftTypes)
+{
+  ScIterator5Ptr itEmployees = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_employee);
+
+  while (itEmployees->Next())
+  {
+    EmployeeInfo info;
+    info.addr = itEmployees->Get(2);
+
+    // У каждого сотрудника должна быть роль; некорректные записи пропускаем.
+    ScIterator5Ptr itRole = CreateIterator5(
+        info.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_has_role);
+    if (itRole->Next())
+    {
+      info.role = itRole->Get(2);
+    }
+    else
+    {
+      m_logger.Warning("Employee without role skipped");
+      continue;
+    }
+
+    // Если доступные типы смен не указаны, считаем, что сотрудник доступен для всех типов.
+    ScIterator5Ptr itShiftType = CreateIterator5(
+        info.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_available_shift_type);
+    while (itShiftType->Next())
+    {
+      info.availableShiftTypes.push_back(itShiftType->Get(2));
+    }
+    if (info.availableShiftTypes.empty())
+    {
+      info.availableShiftTypes = allShiftTypes;
+    }
+
+    ScIterator5Ptr itPreferred = CreateIterator5(
+        info.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_preferred_shift_type);
+    while (itPreferred->Next())
+      AddPreference(info, itPreferred->Get(2), itPreferred->Get(1));
+
+    // Читаем недельный лимит; если его нет или он неверный, используем 5.
+    ScIterator5Ptr itMax = CreateIterator5(
+        info.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNodeLink,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_max_shifts_per_week);
+    if (itMax->Next())
+    {
+      ScAddr const & linkAddr = itMax->Get(2);
+      string value;
+      if (m_context.GetLinkContent(linkAddr, value))
+      {
+        try
+        {
+          info.maxShifts = static_cast<size_t>(stoi(value));
+        }
+        catch (exception const &)
+        {
+          info.maxShifts = 5;
+        }
+      }
+    }
+
+    m_employees.push_back(info);
+  }
+}
+
+void StaffScheduleBuilder::ReadStaffByRelations(vector<ScAddr> const & allShiftTypes)
+{
+  // От ресторана читаем только список сотрудников, атрибуты собираем одним обходом каждого отношения.
+  ScAddrIndex employeeIndex;
+  vector<EmployeeInfo> employees;
+  ScIterator5Ptr itEmployees = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_employee);
+  while (itEmployees->Next())
+  {
+    ScAddr const & employeeAddr = itEmployees->Get(2);
+    if (employeeIndex.Add(employeeAddr) < employees.size())
+      continue;
+    EmployeeInfo info;
+    info.addr = employeeAddr;
+    employees.push_back(info);
+  }
+
+  vector<char> hasRole(employees.size(), 0);
+  ForEachRelationPair(StaffScheduleKeynodes::nrel_has_role, [&](ScAddr const & source, ScAddr const & target) {
+    size_t const i = employeeIndex.Find(source);
+    if (i == ScAddrIndex::NotFound || hasRole[i])
+      return;
+    employees[i].role = target;
+    hasRole[i] = 1;
+  });
+
+  ForEachRelationPair(
+      StaffScheduleKeynodes::nrel_available_shift_type, [&](ScAddr const & source, ScAddr const & target) {
+        size_t const i = employeeIndex.Find(source);
+        if (i != ScAddrIndex::NotFound)
+          employees[i].availableShiftTypes.push_back(target);
+      });
+
+  // Вес предпочтения лежит на самой дуге отношения, поэтому она передаётся вместе с парой.
+  ForEachRelationPair(
+      StaffScheduleKeynodes::nrel_preferred_shift_type,
+      [&](ScAddr const & source, ScAddr const & target, ScAddr const & arc) {
+        size_t const i = employeeIndex.Find(source);
+        if (i != ScAddrIndex::NotFound)
+          AddPreference(employees[i], target, arc);
+      });
+
+  vector<char> hasMaxShifts(employees.size(), 0);
+  ForEachRelationPair(
+      StaffScheduleKeynodes::nrel_max_shifts_per_week, [&](ScAddr const & source, ScAddr const & target) {
+        size_t const i = employeeIndex.Find(source);
+        if (i == ScAddrIndex::NotFound || hasMaxShifts[i])
+          return;
+        hasMaxShifts[i] = 1;
+
+        // Неверный лимит заменяем на 5, как и при чтении по сотрудникам.
+        string value;
+        if (!m_context.GetElementType(target).IsLink() || !m_context.GetLinkContent(target, value))
+          return;
+        try
+        {
+          employees[i].maxShifts = static_cast<size_t>(stoi(value));
+        }
+        catch (exception const &)
+        {
+          employees[i].maxShifts = 5;
+        }
+      });
+
+  for (size_t i = 0; i < employees.size(); ++i)
+  {
+    if (!hasRole[i])
+    {
+      m_logger.Warning("Employee without role skipped");
+      continue;
+    }
+    if (employees[i].availableShiftTypes.empty())
+      employees[i].availableShiftTypes = allShiftTypes;
+    m_employees.push_back(move(employees[i]));
+  }
+}
+
+void StaffScheduleBuilder::ReadShifts()
+{
+  ScAddrIndex shiftIndex;
+  ScIterator5Ptr itShifts = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_shift);
+  while (itShifts->Next())
+    shiftIndex.Add(itShifts->Get(2));
+
+  // Базы, где смены ещё не привязаны к ресторанам, читаются по-старому: берутся все смены,
+  // которые не принадлежат ни одному ресторану.
+  if (shiftIndex.GetSize() == 0)
+  {
+    ScIterator3Ptr itAllShifts = CreateIterator3(
+        StaffScheduleKeynodes::concept_shift,
+        ScType::ConstPermPosArc,
+        ScType::ConstNode);
+    while (itAllShifts->Next())
+    {
+      ScAddr const & shiftAddr = itAllShifts->Get(2);
+      ScIterator5Ptr itOwner = CreateIterator5(
+          ScType::ConstNode,
+          ScType::ConstCommonArc,
+          shiftAddr,
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::nrel_has_shift);
+      if (!itOwner->Next())
+        shiftIndex.Add(shiftAddr);
+    }
+    if (shiftIndex.GetSize() > 0)
+      m_logger.Warning("Restaurant has no nrel_has_shift, shifts without restaurant are used");
+  }
+
+  // Дни и типы общие для многих смен, поэтому следующий день и часы читаются один раз на день и на тип.
+  unordered_map<ScAddr, ScAddr, ScAddrHashFunc> nextDays;
+  unordered_map<ScAddr, pair<size_t, size_t>, ScAddrHashFunc> typeHours;
+  for (size_t j = 0; j < shiftIndex.GetSize(); ++j)
+  {
+    ShiftInfo shift;
+    shift.addr = shiftIndex.GetAddr(j);
+
+    ScIterator5Ptr itType = CreateIterator5(
+        shift.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_shift_type);
+    if (!itType->Next())
+    {
+      m_logger.Warning("Shift without type skipped");
+      continue;
+    }
+    shift.shiftType = itType->Get(2);
+
+    ScIterator5Ptr itDay = CreateIterator5(
+        shift.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_shift_day);
+    if (itDay->Next())
+    {
+      shift.day = itDay->Get(2);
+      auto [itNextDay, added] = nextDays.emplace(shift.day, ScAddr::Empty);
+      if (added)
+      {
+        ScIterator5Ptr itNext = CreateIterator5(
+            shift.day,
+            ScType::ConstCommonArc,
+            ScType::ConstNode,
+            ScType::ConstPermPosArc,
+            StaffScheduleKeynodes::nrel_next_day);
+        if (itNext->Next())
+          itNextDay->second = itNext->Get(2);
+      }
+      shift.nextDay = itNextDay->second;
+    }
+
+    auto [itHours, added] = typeHours.emplace(shift.shiftType, pair(ShiftInfo::NoHour, ShiftInfo::NoHour));
+    if (added)
+    {
+      size_t const startHour = ReadCount(shift.shiftType, StaffScheduleKeynodes::nrel_start_hour, ShiftInfo::NoHour);
+      size_t const endHour = ReadCount(shift.shiftType, StaffScheduleKeynodes::nrel_end_hour, ShiftInfo::NoHour);
+      // Без обоих часов смена не участвует в проверке отдыха.
+      if (startHour <= 24 && endHour <= 24)
+        itHours->second = {startHour, endHour};
+      else if (startHour != ShiftInfo::NoHour || endHour != ShiftInfo::NoHour)
+        m_logger.Warning("Shift type hours ignored");
+    }
+    tie(shift.startHour, shift.endHour) = itHours->second;
+
+    m_shifts.push_back(shift);
+  }
+}
+
+void StaffScheduleBuilder::ReadRequirements()
+{
+  vector<StaffRequirement> restaurantRequirements;
+  ReadRequirementsOf(m_restaurantAddr, restaurantRequirements);
+  if (restaurantRequirements.empty())
+  {
+    // Прежний состав смены остаётся для баз, где требования ещё не заданы.
+    restaurantRequirements = {
+        {StaffScheduleKeynodes::concept_cook, 1},
+        {StaffScheduleKeynodes::concept_waiter, 2},
+        {StaffScheduleKeynodes::concept_cleaner, 1},
+        {StaffScheduleKeynodes::concept_admin, 1}};
+  }
+
+  // Требования типа смены читаются один раз на тип, требования смены — для каждой смены.
+  unordered_map<ScAddr, vector<StaffRequirement>, ScAddrHashFunc> typeRequirements;
+  for (auto & shift : m_shifts)
+  {
+    auto [it, added] = typeRequirements.emplace(shift.shiftType, vector<StaffRequirement>());
+    if (added)
+    {
+      it->second = restaurantRequirements;
+      ReadRequirementsOf(shift.shiftType, it->second);
+    }
+    shift.requirements = it->second;
+    ReadRequirementsOf(shift.addr, shift.requirements);
+  }
+}
+
+void StaffScheduleBuilder::ReadRequirementsOf(ScAddr const & owner, vector<StaffRequirement> & requirements)
+{
+  ScIterator5Ptr itRequirements = CreateIterator5(
+      owner,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_staffing_requirement);
+  while (itRequirements->Next())
+  {
+    ScAddr const & requirementAddr = itRequirements->Get(2);
+    ScIterator5Ptr itRole = CreateIterator5(
+        requirementAddr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_required_role);
+    ScIterator5Ptr itCount = CreateIterator5(
+        requirementAddr,
+        ScType::ConstCommonArc,
+        ScType::ConstNodeLink,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_required_count);
+    string value;
+    if (!itRole->Next() || !itCount->Next() || !m_context.GetLinkContent(itCount->Get(2), value))
+    {
+      m_logger.Warning("Staffing requirement without role or count skipped");
+      continue;
+    }
+
+    int count = 0;
+    try
+    {
+      count = stoi(value);
+    }
+    catch (exception const &)
+    {
+      count = -1;
+    }
+    if (count < 0)
+    {
+      m_logger.Warning("Staffing requirement with invalid count skipped");
+      continue;
+    }
+
+    StaffRequirement const requirement{itRole->Get(2), static_cast<size_t>(count)};
+
+    auto const it = find_if(requirements.begin(), requirements.end(), [&](StaffRequirement const & other) {
+      return other.role == requirement.role;
+    });
+    if (it != requirements.end())
+      it->count = requirement.count;
+    else
+      requirements.push_back(requirement);
+  }
+}
+
+void StaffScheduleBuilder::IndexStaffData()
+{
+  // Плотные номера типов смен и ролей заменяют поиск по спискам ScAddr.
+  m_shiftTypeIndex.Clear();
+  m_roleIndex.Clear();
+  m_shiftIndex.Clear();
+  m_employeeIndex.Clear();
+  for (auto & shift : m_shifts)
+  {
+    m_shiftIndex.Add(shift.addr);
+    shift.shiftTypeIndex = m_shiftTypeIndex.Add(shift.shiftType);
+  }
+  IndexDays();
+  for (auto & employee : m_employees)
+  {
+    m_employeeIndex.Add(employee.addr);
+    employee.roleIndex = m_roleIndex.Add(employee.role);
+    for (auto const & shiftType : employee.availableShiftTypes)
+      m_shiftTypeIndex.Add(shiftType);
+  }
+
+  size_t const employeeCount = m_employees.size();
+  size_t const typeCount = m_shiftTypeIndex.GetSize();
+  size_t const roleCount = m_roleIndex.GetSize();
+  m_shiftsByType.assign(typeCount, {});
+  m_typeEmployees.assign(typeCount, EmployeeBitset(employeeCount));
+  m_roleEmployees.assign(roleCount, EmployeeBitset(employeeCount));
+
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+    m_shiftsByType[m_shifts[j].shiftTypeIndex].push_back(j);
+
+  for (size_t i = 0; i < employeeCount; ++i)
+  {
+    EmployeeInfo const & employee = m_employees[i];
+    m_roleEmployees[employee.roleIndex].Set(i);
+    for (auto const & shiftType : employee.availableShiftTypes)
+      m_typeEmployees[m_shiftTypeIndex.Find(shiftType)].Set(i);
+  }
+
+  // Кандидаты на пару (роль, тип смены) — пересечение столбцов матрицы доступности и матрицы ролей.
+  m_candidates.clear();
+  m_candidates.reserve(roleCount * typeCount);
+  for (size_t r = 0; r < roleCount; ++r)
+  {
+    for (size_t t = 0; t < typeCount; ++t)
+    {
+      m_candidates.push_back(m_roleEmployees[r]);
+      m_candidates.back() &= m_typeEmployees[t];
+    }
+  }
+}
+
+EmployeeBitset const * StaffScheduleBuilder::FindCandidates(ScAddr const & role, size_t shiftTypeIndex) const
+{
+  size_t const roleIndex = m_roleIndex.Find(role);
+  if (roleIndex == ScAddrIndex::NotFound)
+    return nullptr;
+  return &m_candidates[roleIndex * m_shiftTypeIndex.GetSize() + shiftTypeIndex];
+}
+
+void StaffScheduleBuilder::BuildFlowNetwork(bool generateDebugGraph)
+{
+  GenerateCanWorkArcs();
+  if (generateDebugGraph)
+    GenerateEmployeeSlots();
+
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "flow_network");
+  ReadScheduleSettings();
+
+  // Потребность смены в роли — одна вершина с ёмкостью, равной числу нужных сотрудников.
+  m_demands.clear();
+  m_shiftDemandStart.assign(m_shifts.size() + 1, 0);
+  m_slotCount = 0;
+  m_flow = 0;
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+  {
+    m_shiftDemandStart[j] = m_demands.size();
+    for (auto const & requirement : m_shifts[j].requirements)
+    {
+      if (requirement.count == 0)
+        continue;
+      m_demands.push_back({j, requirement.role, requirement.count});
+      m_slotCount += requirement.count;
+    }
+  }
+  m_shiftDemandStart[m_shifts.size()] = m_demands.size();
+
+  // Ограничения: не более одной роли в одной смене для сотрудника (единичная дуга к потребности),
+  // maxShifts в неделю (ёмкость дуги из истока) и лимит смен в день (ёмкость дуги к вершине дня).
+  size_t employeeCount = m_employees.size();
+  size_t demandCount = m_demands.size();
+
+  m_demandStart = employeeCount;
+  m_source = m_demandStart + demandCount;
+  m_sink = m_source + 1;
+  m_dayNodeStart = m_sink + 1;
+  m_dayEdgeStart = employeeCount;
+
+  // Кандидаты каждой потребности берутся из готового битового множества, их число — popcount.
+  vector<EmployeeBitset const *> demandCandidates(demandCount);
+  size_t edgeCount = employeeCount + demandCount;
+  for (size_t d = 0; d < demandCount; ++d)
+  {
+    demandCandidates[d] = FindCandidates(m_demands[d].role, m_shifts[m_demands[d].shiftIndex].shiftTypeIndex);
+    if (demandCandidates[d] != nullptr)
+      edgeCount += demandCandidates[d]->Count();
+  }
+
+  // Вершина дня нужна, только если у сотрудника в этот день кандидатских потребностей больше лимита,
+  // поэтому сеть растёт не больше чем на сотрудников × дни.
+  size_t const dayCount = m_dayIndex.GetSize();
+  m_dayNodeEmployee.clear();
+  m_employeeDayNode.clear();
+  if (m_maxShiftsPerDay != 0 && dayCount != 0)
+  {
+    vector<size_t> dayDemandCount(employeeCount * dayCount, 0);
+    for (size_t d = 0; d < demandCount; ++d)
+    {
+      size_t const dayIndex = m_shifts[m_demands[d].shiftIndex].dayIndex;
+      if (demandCandidates[d] == nullptr || dayIndex == ScAddrIndex::NotFound)
+        continue;
+      demandCandidates[d]->ForEach([&](size_t i) {
+        ++dayDemandCount[i * dayCount + dayIndex];
+      });
+    }
+
+    m_employeeDayNode.assign(employeeCount * dayCount, ScAddrIndex::NotFound);
+    for (size_t k = 0; k < m_employeeDayNode.size(); ++k)
+    {
+      if (dayDemandCount[k] <= m_maxShiftsPerDay)
+        continue;
+      m_employeeDayNode[k] = m_dayNodeStart + m_dayNodeEmployee.size();
+      m_dayNodeEmployee.push_back(k / dayCount);
+    }
+    edgeCount += m_dayNodeEmployee.size();
+  }
+
+  m_network.Reset(m_dayNodeStart + m_dayNodeEmployee.size());
+  m_network.ReserveEdges(edgeCount);
+
+  for (size_t i = 0; i < employeeCount; ++i)
+  {
+    m_network.AddEdge(m_source, i, static_cast<int>(m_employees[i].maxShifts));
+  }
+
+  for (size_t k = 0; k < m_dayNodeEmployee.size(); ++k)
+  {
+    m_network.AddEdge(m_dayNodeEmployee[k], m_dayNodeStart + k, static_cast<int>(m_maxShiftsPerDay));
+  }
+
+  for (size_t d = 0; d < demandCount; ++d)
+  {
+    if (demandCandidates[d] == nullptr)
+      continue;
+    size_t const demandNode = m_demandStart + d;
+    size_t const shiftIndex = m_demands[d].shiftIndex;
+    demandCandidates[d]->ForEach([&](size_t i) {
+      m_network.AddEdge(GetEntryNode(i, shiftIndex), demandNode, 1);
+    });
+  }
+
+  // Дуги в сток добавляются последними, по одной на потребность.
+  m_sinkEdgeStart = edgeCount - demandCount;
+  for (size_t d = 0; d < demandCount; ++d)
+  {
+    m_network.AddEdge(m_demandStart + d, m_sink, static_cast<int>(m_demands[d].count));
+  }
+
+  m_network.Build();
+}
+
+size_t StaffScheduleBuilder::FindMaxFlow(ScheduleSolverType solverType)
+{
+  m_solverType = solverType;
+  {
+    StaffScheduleMetrics::PhaseScope phase(m_metrics, "max_flow");
+
+    // Потребности разных дней решаются отдельно; сотрудник, работающий в несколько дней, связывает части,
+    // и их потоки выравнивает Dinic по всей сети. Предпочтения сотрудников становятся стоимостями дуг назначений.
+    unique_ptr<ScheduleSolver> solver;
+    if (solverType == ScheduleSolverType::Decomposed)
+      solver = make_unique<DecomposedMaxFlow>(GetDemandDayParts());
+    else if (solverType == ScheduleSolverType::Preference)
+      solver = make_unique<WeightedMaxFlow>(GetPreferenceCosts());
+    else
+      solver = CreateScheduleSolver(solverType);
+    // Поток, уже лежащий в сети (например, из прежнего графика), только дополняется.
+    m_flow += static_cast<size_t>(solver->Solve(m_network, m_source, m_sink));
+
+    for (auto const & [name, value] : solver->GetCounters())
+      m_metrics.AddCounter(name, value);
+  }
+
+  // Отдых проверяется отдельной стадией, поэтому её цена видна рядом с решением без ограничений.
+  if (m_minRestHours != 0)
+    ResolveRestConflicts();
+  return m_flow;
+}
+
+ScStructure StaffScheduleBuilder::WriteSchedule()
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "write_schedule");
+
+  // Результат сначала собирается в буфере и записывается одним проходом вместе со структурой.
+  ScheduleResultWriter writer(m_context);
+
+  // Новый график становится текущим графиком ресторана, прежние графики остаются в базе.
+  ScIterator5Ptr itCurrent = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  while (itCurrent->Next())
+    m_context.EraseElement(itCurrent->Get(1));
+
+  ElementId const restaurant = writer.AddExisting(m_restaurantAddr, true);
+  ElementId const schedule = writer.AddNode(ScType::ConstNode, true);
+  writer.AddToClass(StaffScheduleKeynodes::concept_week_schedule, schedule);
+  writer.AddRelation(restaurant, schedule, StaffScheduleKeynodes::nrel_current_schedule, true);
+
+  ElementId const scheduleIdtf = writer.AddLink("Weekly staff schedule");
+  writer.AddConnector(ScType::ConstPermPosArc, schedule, scheduleIdtf);
+  writer.AddRelation(schedule, scheduleIdtf, StaffScheduleKeynodes::nrel_main_idtf);
+
+  vector<ElementId> shiftIds;
+  shiftIds.reserve(m_shifts.size());
+  for (auto const & shift : m_shifts)
+  {
+    shiftIds.push_back(writer.AddExisting(shift.addr, true));
+    writer.AddConnector(ScType::ConstPermPosArc, schedule, shiftIds.back());
+  }
+
+  vector<ElementId> employeeIds;
+  employeeIds.reserve(m_employees.size());
+  for (auto const & employee : m_employees)
+    employeeIds.push_back(writer.AddExisting(employee.addr, true));
+
+  // Назначения, резервы, проблемы и расписания сотрудников входят в график,
+  // чтобы их можно было найти от узла графика при исправлении.
+  vector<vector<size_t>> assignedPerDemand = CollectAssignments();
+  if (m_substituteCount != 0)
+    SearchAlternatingPaths();
+  size_t substituteCount = 0;
+  for (size_t d = 0; d < m_demands.size(); ++d)
+  {
+    size_t const shiftIndex = m_demands[d].shiftIndex;
+    for (size_t employeeIndex : assignedPerDemand[d])
+    {
+      ElementId const assignedArc = writer.AddRelation(
+          shiftIds[shiftIndex], employeeIds[employeeIndex], StaffScheduleKeynodes::nrel_assigned_employee, true);
+      writer.AddConnector(ScType::ConstPermPosArc, schedule, assignedArc);
+      if (m_substituteCount != 0)
+        substituteCount += AddSubstitutes(writer, assignedArc, d, employeeIndex, shiftIds, employeeIds);
+    }
+  }
+
+  // Проверяем полноту укомплектования смен и сохраняем причины.
+  bool const allShiftsStaffed = (m_flow == m_slotCount);
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+    AddStaffingIssues(writer, schedule, shiftIds[j], j, assignedPerDemand);
+
+  ElementId const staffedLink = writer.AddLink(allShiftsStaffed ? "true" : "false", true);
+  writer.AddRelation(schedule, staffedLink, StaffScheduleKeynodes::nrel_all_shifts_staffed);
+
+  // Равномерность нагрузки: стандартное отклонение числа смен сотрудников.
+  ElementId const deviationLink = writer.AddLink(GetShiftCountDeviation(), true);
+  writer.AddRelation(schedule, deviationLink, StaffScheduleKeynodes::nrel_shift_count_deviation);
+  writer.AddRelation(
+      schedule, writer.AddExisting(GetScheduleSolverClass(m_solverType)), StaffScheduleKeynodes::nrel_schedule_solver);
+
+  // Добавляем резервы для каждой смены и роли.
+  size_t reserveCount = 0;
+  for (size_t j = 0; j < m_shifts.size(); ++j)
+    reserveCount += AddReserves(writer, schedule, shiftIds[j], employeeIds, j, assignedPerDemand);
+  m_metrics.AddCounter("reserves", reserveCount);
+  m_metrics.AddCounter("substitutes", substituteCount);
+
+  for (size_t i = 0; i < m_employees.size(); ++i)
+    AddEmployeeSchedule(writer, schedule, employeeIds[i], shiftIds, i);
+
+  ScStructure result = writer.Commit();
+  m_metrics.AddElements(writer.GetGeneratedCount());
+  m_scheduleAddr = writer.GetAddr(schedule);
+  return result;
+}
+
+vector<vector<size_t>> StaffScheduleBuilder::CollectAssignments()
+{
+  vector<vector<size_t>> assignedPerDemand(m_demands.size());
+  for (auto & employee : m_employees)
+  {
+    employee.assignedCount = 0;
+    employee.assignedShifts.clear();
+  }
+
+  // Поток по дуге «сотрудник или его день → потребность» хранится в ёмкости обратной дуги.
+  for (size_t d = 0; d < m_demands.size(); ++d)
+  {
+    ShiftInfo const & shift = m_shifts[m_demands[d].shiftIndex];
+    size_t const demandNode = m_demandStart + d;
+    for (size_t a = m_network.ArcsBegin(demandNode); a < m_network.ArcsEnd(demandNode); ++a)
+    {
+      FlowNetwork::Arc const & arc = m_network.GetArc(a);
+      size_t const employeeIndex = GetNodeEmployee(static_cast<size_t>(arc.to));
+      if (employeeIndex == ScAddrIndex::NotFound || arc.cap != 1)
+        continue;
+
+      EmployeeInfo & employee = m_employees[employeeIndex];
+      employee.assignedCount += 1;
+      employee.assignedShifts.push_back(shift.addr);
+      assignedPerDemand[d].push_back(employeeIndex);
+    }
+  }
+  return assignedPerDemand;
+}
+
+void StaffScheduleBuilder::AddStaffingIssues(
+    ScheduleResultWriter & writer,
+    ElementId schedule,
+    ElementId shift,
+    size_t shiftIndex,
+    vector<vector<size_t>> const & assignedPerDemand)
+{
+  for (size_t d = m_shiftDemandStart[shiftIndex]; d < m_shiftDemandStart[shiftIndex + 1]; ++d)
+  {
+    ShiftDemand const & demand = m_demands[d];
+    size_t const count = assignedPerDemand[d].size();
+    if (count >= demand.count)
+      continue;
+
+    m_logger.Warning("Shift has insufficient staff for required role");
+    ElementId const issue = writer.AddNode(ScType::ConstNode, true);
+    writer.AddToClass(StaffScheduleKeynodes::concept_staffing_issue, issue);
+    writer.AddConnector(ScType::ConstPermPosArc, schedule, issue);
+    writer.AddRelation(issue, shift, StaffScheduleKeynodes::nrel_missing_shift);
+    writer.AddRelation(issue, writer.AddExisting(demand.role), StaffScheduleKeynodes::nrel_missing_role);
+    ElementId const missingCount = writer.AddLink(to_string(demand.count - count));
+    writer.AddRelation(issue, missingCount, StaffScheduleKeynodes::nrel_missing_count);
+  }
+}
+
+size_t StaffScheduleBuilder::AddReserves(
+    ScheduleResultWriter & writer,
+    ElementId schedule,
+    ElementId shift,
+    vector<ElementId> const & employeeIds,
+    size_t shiftIndex,
+    vector<vector<size_t>> const & assignedPerDemand)
+{
+  if (m_reserveCount == 0)
+    return 0;
+
+  EmployeeBitset assignedToShift(m_employees.size());
+  for (size_t d = m_shiftDemandStart[shiftIndex]; d < m_shiftDemandStart[shiftIndex + 1]; ++d)
+  {
+    for (size_t employeeIndex : assignedPerDemand[d])
+      assignedToShift.Set(employeeIndex);
+  }
+
+  // Лучшие кандидаты держатся упорядоченными по запасу смен; при равном запасе раньше идёт меньший индекс.
+  // Число резервов берётся из базы как есть, поэтому ограничивается числом сотрудников.
+  size_t const reserveLimit = min(m_reserveCount, m_employees.size());
+  vector<size_t> reserves;
+  reserves.reserve(reserveLimit + 1);
+  auto const hasMoreShiftsLeft = [this](size_t shiftsLeft, size_t employeeIndex) {
+    return shiftsLeft > GetShiftsLeft(employeeIndex);
+  };
+
+  size_t addedCount = 0;
+  for (auto const & requirement : m_shifts[shiftIndex].requirements)
+  {
+    if (requirement.count == 0)
+      continue;
+    EmployeeBitset const * candidates = FindCandidates(requirement.role, m_shifts[shiftIndex].shiftTypeIndex);
+    if (candidates == nullptr)
+      continue;
+
+    // Сотрудник, исчерпавший недельный или дневной лимит, заменить никого не сможет.
+    reserves.clear();
+    candidates->ForEachNotIn(assignedToShift, [&](size_t employeeIndex) {
+      size_t const shiftsLeft = GetShiftsLeft(employeeIndex);
+      if (shiftsLeft == 0 || !HasDayLeft(employeeIndex, shiftIndex))
+        return;
+      if (reserves.size() == reserveLimit && !hasMoreShiftsLeft(shiftsLeft, reserves.back()))
+        return;
+      reserves.insert(upper_bound(reserves.begin(), reserves.end(), shiftsLeft, hasMoreShiftsLeft), employeeIndex);
+      if (reserves.size() > reserveLimit)
+        reserves.pop_back();
+    });
+
+    for (size_t employeeIndex : reserves)
+    {
+      ElementId const reserveArc = writer.AddRelation(
+          shift, employeeIds[employeeIndex], StaffScheduleKeynodes::nrel_reserve_employee, true);
+      writer.AddConnector(ScType::ConstPermPosArc, schedule, reserveArc);
+    }
+    addedCount += reserves.size();
+  }
+  return addedCount;
+}
+
+void StaffScheduleBuilder::AddEmployeeSchedule(
+    ScheduleResultWriter & writer,
+    ElementId schedule,
+    ElementId employee,
+    vector<ElementId> const & shiftIds,
+    size_t employeeIndex)
+{
+  ElementId const employeeSchedule = writer.AddNode(ScType::ConstNode);
+  writer.AddToClass(StaffScheduleKeynodes::concept_week_schedule, employeeSchedule);
+  for (auto const & shiftAddr : m_employees[employeeIndex].assignedShifts)
+    writer.AddConnector(ScType::ConstPermPosArc, employeeSchedule, shiftIds[m_shiftIndex.Find(shiftAddr)]);
+
+  ElementId const scheduleArc =
+      writer.AddRelation(employee, employeeSchedule, StaffScheduleKeynodes::nrel_employee_schedule, true);
+  writer.AddConnector(ScType::ConstPermPosArc, schedule, scheduleArc);
+
+  ElementId const countArc = writer.AddRelation(
+      employee,
+      writer.AddLink(to_string(m_employees[employeeIndex].assignedCount)),
+      StaffScheduleKeynodes::nrel_shift_count,
+      true);
+  writer.AddConnector(ScType::ConstPermPosArc, schedule, countArc);
+}
+
+string StaffScheduleBuilder::GetShiftCountDeviation() const
+{
+  double mean = 0;
+  for (auto const & employee : m_employees)
+    mean += static_cast<double>(employee.assignedCount);
+  mean = m_employees.empty() ? 0 : mean / m_employees.size();
+
+  double variance = 0;
+  for (auto const & employee : m_employees)
+  {
+    double const difference = static_cast<double>(employee.assignedCount) - mean;
+    variance += difference * difference;
+  }
+  variance = m_employees.empty() ? 0 : variance / m_employees.size();
+
+  ostringstream stream;
+  stream << fixed << setprecision(2) << sqrt(variance);
+  return stream.str();
+}
+
+size_t StaffScheduleBuilder::GetShiftsLeft(size_t employeeIndex) const
+{
+  EmployeeInfo const & employee = m_employees[employeeIndex];
+  return employee.maxShifts > employee.assignedCount ? employee.maxShifts - employee.assignedCount : 0;
+}
+
+void StaffScheduleBuilder::ReadScheduleSettings()
+{
+  m_reserveCount = ReadRestaurantCount(StaffScheduleKeynodes::nrel_reserve_count, DefaultReserveCount);
+  // Замены нумеруются ролями rrel_1, rrel_2 и т. д., поэтому их не больше, чем таких ролей.
+  m_substituteCount = min(
+      ReadRestaurantCount(StaffScheduleKeynodes::nrel_substitute_count, DefaultSubstituteCount),
+      ScKeynodes::GetRrelIndexNum());
+  m_maxShiftsPerDay = ReadRestaurantCount(StaffScheduleKeynodes::nrel_max_shifts_per_day, 0);
+  m_minRestHours = ReadRestaurantCount(StaffScheduleKeynodes::nrel_min_rest_hours, 0);
+}
+
+size_t StaffScheduleBuilder::ReadRestaurantCount(ScAddr const & relation, size_t defaultCount)
+{
+  return ReadCount(m_restaurantAddr, relation, defaultCount);
+}
+
+size_t StaffScheduleBuilder::ReadCount(ScAddr const & owner, ScAddr const & relation, size_t defaultCount)
+{
+  ScIterator5Ptr itCount =
+      CreateIterator5(owner, ScType::ConstCommonArc, ScType::ConstNodeLink, ScType::ConstPermPosArc, relation);
+  string value;
+  if (!itCount->Next() || !m_context.GetLinkContent(itCount->Get(2), value))
+    return defaultCount;
+
+  try
+  {
+    int const count = stoi(value);
+    if (count >= 0)
+      return static_cast<size_t>(count);
+    m_logger.Warning("Negative count ignored");
+  }
+  catch (exception const &)
+  {
+    m_logger.Warning("Invalid count ignored");
+  }
+  return defaultCount;
+}
+
+void StaffScheduleBuilder::AddPreference(
+    EmployeeInfo & employee,
+    ScAddr const & shiftType,
+    ScAddr const & preferenceArc)
+{
+  auto const isSameType = [&](ShiftPreference const & preference) {
+    return preference.shiftType == shiftType;
+  };
+  if (any_of(employee.preferredShiftTypes.begin(), employee.preferredShiftTypes.end(), isSameType))
+    return;
+
+  // Предпочтение без веса весит 1. Вес ограничен сверху, потому что от него зависит число корзин
+  // расстояний в WeightedMaxFlow; предпочтение с отрицательным весом не учитывается.
+  ShiftPreference preference{shiftType, 1};
+  ScIterator5Ptr itWeight = CreateIterator5(
+      preferenceArc,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_preference_weight);
+  string value;
+  if (itWeight->Next() && m_context.GetLinkContent(itWeight->Get(2), value))
+  {
+    try
+    {
+      preference.weight = stoi(value);
+    }
+    catch (exception const &)
+    {
+      m_logger.Warning("Invalid preference weight ignored");
+    }
+  }
+  if (preference.weight < 0)
+  {
+    m_logger.Warning("Negative preference weight ignored");
+    return;
+  }
+  if (preference.weight > ShiftPreference::MaxWeight)
+  {
+    m_logger.Warning("Preference weight is limited to ", ShiftPreference::MaxWeight);
+    preference.weight = ShiftPreference::MaxWeight;
+  }
+  employee.preferredShiftTypes.push_back(preference);
+}
+
+void StaffScheduleBuilder::WriteMetrics(ScStructure & result)
+{
+  // График, обновляемый на месте, хранит метрики только последнего запуска.
+  ScIterator5Ptr itMetrics = CreateIterator5(
+      m_scheduleAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_schedule_metrics);
+  if (itMetrics->Next())
+  {
+    m_context.SetLinkContent(itMetrics->Get(2), m_metrics.ToJson());
+    result << itMetrics->Get(2) << itMetrics->Get(1);
+    return;
+  }
+
+  ScAddr metricsLink = m_context.GenerateLink();
+  m_context.SetLinkContent(metricsLink, m_metrics.ToJson());
+  ScAddr metricsArc = m_context.GenerateConnector(
+      ScType::ConstCommonArc,
+      m_scheduleAddr,
+      metricsLink);
+  m_context.GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_schedule_metrics,
+      metricsArc);
+  result << metricsLink << metricsArc;
+}
+
+std::vector<EmployeeInfo> const & StaffScheduleBuilder::GetEmployees() const
+{
+  return m_employees;
+}
+
+std::vector<ShiftInfo> const & StaffScheduleBuilder::GetShifts() const
+{
+  return m_shifts;
+}
+
+size_t StaffScheduleBuilder::GetSlotCount() const
+{
+  return m_slotCount;
+}
+
+ScAddr StaffScheduleBuilder::GetScheduleAddr() const
+{
+  return m_scheduleAddr;
+}
+
+StaffScheduleMetrics const & StaffScheduleBuilder::GetMetrics() const
+{
+  return m_metrics;
+}
+
+FlowNetwork const & StaffScheduleBuilder::GetNetwork() const
+{
+  return m_network;
+}
+
+size_t StaffScheduleBuilder::GetSource() const
+{
+  return m_source;
+}
+
+size_t StaffScheduleBuilder::GetSink() const
+{
+  return m_sink;
+}
+
+vector<size_t> StaffScheduleBuilder::GetDemandDayParts() const
+{
+  vector<size_t> parts(m_network.GetNodeCount(), 0);
+  for (size_t d = 0; d < m_demands.size(); ++d)
+  {
+    size_t const dayIndex = m_shifts[m_demands[d].shiftIndex].dayIndex;
+    if (dayIndex != ScAddrIndex::NotFound)
+      parts[m_demandStart + d] = dayIndex + 1;
+  }
+  return parts;
+}
+
+vector<int> StaffScheduleBuilder::GetPreferenceCosts() const
+{
+  size_t const typeCount = m_shiftTypeIndex.GetSize();
+  vector<int> weights(m_employees.size() * typeCount, 0);
+  int maxWeight = 0;
+  for (size_t i = 0; i < m_employees.size(); ++i)
+  {
+    for (auto const & preference : m_employees[i].preferredShiftTypes)
+    {
+      size_t const shiftTypeIndex = m_shiftTypeIndex.Find(preference.shiftType);
+      if (shiftTypeIndex == ScAddrIndex::NotFound)
+        continue;
+      weights[i * typeCount + shiftTypeIndex] = preference.weight;
+      maxWeight = max(maxWeight, preference.weight);
+    }
+  }
+
+  // Все максимальные потоки содержат одинаковое число назначений, поэтому наименьший недобор
+  // до сильнейшего предпочтения даёт наибольший суммарный вес, а стоимости остаются неотрицательными.
+  auto const getCost = [&](size_t entryNode, size_t demandNode) {
+    size_t const shiftTypeIndex = m_shifts[m_demands[demandNode - m_demandStart].shiftIndex].shiftTypeIndex;
+    return maxWeight - weights[GetNodeEmployee(entryNode) * typeCount + shiftTypeIndex];
+  };
+  auto const isDemand = [&](size_t node) {
+    return node >= m_demandStart && node < m_source;
+  };
+
+  // Дуги вершин лежат подряд, поэтому стоимости заполняются одним проходом: прямая дуга назначения
+  // выходит из сотрудника или его дня, обратная — из потребности.
+  vector<int> costs(2 * m_network.GetEdgeCount(), 0);
+  for (size_t node = 0; node < m_network.GetNodeCount(); ++node)
+  {
+    bool const isEntryNode = GetNodeEmployee(node) != ScAddrIndex::NotFound;
+    if (!isEntryNode && !isDemand(node))
+      continue;
+    for (size_t a = m_network.ArcsBegin(node); a < m_network.ArcsEnd(node); ++a)
+    {
+      size_t const to = static_cast<size_t>(m_network.GetArc(a).to);
+      if (isEntryNode && isDemand(to))
+        costs[a] = getCost(node, to);
+      else if (!isEntryNode && GetNodeEmployee(to) != ScAddrIndex::NotFound)
+        costs[a] = -getCost(to, node);
+    }
+  }
+  return costs;
+}
+
+ScAddr StaffScheduleBuilder::GenerateNode(ScType const & type)
+{
+  m_metrics.AddElements();
+  return m_context.GenerateNode(type);
+}
+
+ScAddr StaffScheduleBuilder::GenerateConnector(ScType const & type, ScAddr const & source, ScAddr const & target)
+{
+  m_metrics.AddElements();
+  return m_context.GenerateConnector(type, source, target);
+}
+
+void StaffScheduleBuilder::GenerateCanWorkArcs()
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "can_work_arcs");
+
+  // Двудольный граф сотрудник -> смена хранится между запусками: сверяем записанные дуги
+  // с текущей доступностью, удаляем устаревшие и повторные, добавляем только недостающие.
+  vector<char> hasCanWork(m_shifts.size());
+  vector<ScAddr> staleArcs;
+  size_t addedCount = 0;
+
+  // Смена, которой больше нет в индексе, может оставаться сменой другого ресторана, где сотрудник тоже
+  // работает; дуга к ней устарела, если смену удалили из concept_shift или ею не владеет другой ресторан.
+  unordered_map<ScAddr, bool, ScAddrHashFunc> shiftUsedElsewhere;
+  auto const isShiftUsedElsewhere = [&](ScAddr const & shiftAddr)
+  {
+    auto const found = shiftUsedElsewhere.find(shiftAddr);
+    if (found != shiftUsedElsewhere.end())
+      return found->second;
+
+    bool used = false;
+    if (m_context.CheckConnector(StaffScheduleKeynodes::concept_shift, shiftAddr, ScType::ConstPermPosArc))
+    {
+      ScIterator5Ptr itOwner = CreateIterator5(
+          ScType::ConstNode,
+          ScType::ConstCommonArc,
+          shiftAddr,
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::nrel_has_shift);
+      while (!used && itOwner->Next())
+        used = itOwner->Get(0) != m_restaurantAddr;
+    }
+    shiftUsedElsewhere.emplace(shiftAddr, used);
+    return used;
+  };
+
+  // Смены без nrel_has_shift общие для ресторанов старого формата, поэтому дуги к ним от чужих
+  // сотрудников трогать нельзя. Если ресторан владеет своими сменами, сотрудник с дугой к ним, которого
+  // нет в индексе, ушёл из ресторана: устарели все его дуги к сменам, которыми не владеет другой ресторан.
+  ScIterator5Ptr itOwnShift = CreateIterator5(
+      m_restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_shift);
+  if (itOwnShift->Next())
+  {
+    ScAddrIndex leftEmployees;
+    for (auto const & shift : m_shifts)
+    {
+      ScIterator5Ptr itCanWork = CreateIterator5(
+          ScType::ConstNode,
+          ScType::ConstCommonArc,
+          shift.addr,
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::nrel_can_work);
+      while (itCanWork->Next())
+      {
+        if (m_employeeIndex.Find(itCanWork->Get(0)) == ScAddrIndex::NotFound)
+          leftEmployees.Add(itCanWork->Get(0));
+      }
+    }
+
+    for (size_t i = 0; i < leftEmployees.GetSize(); ++i)
+    {
+      ScIterator5Ptr itCanWork = CreateIterator5(
+          leftEmployees.GetAddr(i),
+          ScType::ConstCommonArc,
+          ScType::ConstNode,
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::nrel_can_work);
+      while (itCanWork->Next())
+      {
+        if (!isShiftUsedElsewhere(itCanWork->Get(2)))
+          staleArcs.push_back(itCanWork->Get(1));
+      }
+    }
+  }
+
+  for (size_t i = 0; i < m_employees.size(); ++i)
+  {
+    EmployeeInfo const & employee = m_employees[i];
+    fill(hasCanWork.begin(), hasCanWork.end(), 0);
+
+    ScIterator5Ptr itCanWork = CreateIterator5(
+        employee.addr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_can_work);
+    while (itCanWork->Next())
+    {
+      size_t const j = m_shiftIndex.Find(itCanWork->Get(2));
+      if (j == ScAddrIndex::NotFound)
+      {
+        if (!isShiftUsedElsewhere(itCanWork->Get(2)))
+          staleArcs.push_back(itCanWork->Get(1));
+        continue;
+      }
+      if (hasCanWork[j] || !m_typeEmployees[m_shifts[j].shiftTypeIndex].Test(i))
+        staleArcs.push_back(itCanWork->Get(1));
+      else
+        hasCanWork[j] = 1;
+    }
+
+    for (size_t t = 0; t < m_shiftsByType.size(); ++t)
+    {
+      if (!m_typeEmployees[t].Test(i))
+        continue;
+
+      for (size_t j : m_shiftsByType[t])
+      {
+        if (hasCanWork[j])
+          continue;
+        ScAddr arc = GenerateConnector(
+            ScType::ConstCommonArc,
+            employee.addr,
+            m_shifts[j].addr);
+        GenerateConnector(
+            ScType::ConstPermPosArc,
+            StaffScheduleKeynodes::nrel_can_work,
+            arc);
+        ++addedCount;
+      }
+    }
+  }
+
+  for (auto const & arc : staleArcs)
+    m_context.EraseElement(arc);
+  m_metrics.AddCounter("can_work_added", addedCount);
+  m_metrics.AddCounter("can_work_removed", staleArcs.size());
+}
+
+void StaffScheduleBuilder::GenerateEmployeeSlots()
+{
+  StaffScheduleMetrics::PhaseScope phase(m_metrics, "employee_slots");
+
+  // Расширяем граф с учётом максимальной нагрузки: создаём слоты на каждую смену сотрудника.
+  for (size_t i = 0; i < m_employees.size(); ++i)
+  {
+    EmployeeInfo const & employee = m_employees[i];
+    for (size_t k = 0; k < employee.maxShifts; ++k)
+    {
+      ScAddr slotNode = GenerateNode(ScType::ConstNode);
+      GenerateConnector(
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::concept_employee_slot,
+          slotNode);
+
+      ScAddr slotArc = GenerateConnector(
+          ScType::ConstCommonArc,
+          employee.addr,
+          slotNode);
+      GenerateConnector(
+          ScType::ConstPermPosArc,
+          StaffScheduleKeynodes::nrel_employee_slot,
+          slotArc);
+
+      for (size_t t = 0; t < m_shiftsByType.size(); ++t)
+      {
+        if (!m_typeEmployees[t].Test(i))
+          continue;
+
+        for (size_t j : m_shiftsByType[t])
+        {
+          ScAddr canWorkArc = GenerateConnector(
+              ScType::ConstCommonArc,
+              slotNode,
+              m_shifts[j].addr);
+          GenerateConnector(
+              ScType::ConstPermPosArc,
+              StaffScheduleKeynodes::nrel_slot_can_work,
+              canWorkArc);
+        }
+      }
+    }
+  }
+}
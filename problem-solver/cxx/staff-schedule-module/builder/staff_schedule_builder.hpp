@@ -0,0 +1,364 @@
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_iterator.hpp>
+#include <sc-memory/utils/sc_logger.hpp>
+
+#include "builder/schedule_result_writer.hpp"
+#include "metrics/staff_schedule_metrics.hpp"
+#include "model/employee_bitset.hpp"
+#include "model/sc_addr_index.hpp"
+#include "model/staff_schedule_model.hpp"
+#include "solver/flow_network.hpp"
+#include "solver/schedule_solver.hpp"
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//! How ReadStaffData loads employee attributes; shifts of the restaurant are always read one by one.
+enum class StaffDataReadMode
+{
+  //! Iterators from every employee; cost depends only on the staff of the restaurant.
+  PerEntity,
+  /*!
+   * One pass over every employee relation, joined by dense indices; cost depends on the relation size in the base,
+   * so it pays off only when the restaurant holds most of the employees there.
+   */
+  RelationScan
+};
+
+/*!
+ * Builds a weekly staff schedule for one restaurant. Every stage of
+ * BuildStaffScheduleAgent is a separate method, so that it can be measured on its own.
+ */
+class StaffScheduleBuilder
+{
+public:
+  StaffScheduleBuilder(ScMemoryContext & context, utils::ScLogger & logger);
+
+  //! Reads restaurant employees, shift types and shifts from the knowledge base.
+  void ReadStaffData(ScAddr const & restaurantAddr, StaffDataReadMode mode = StaffDataReadMode::PerEntity);
+
+  //! Takes staff data read earlier instead of reading the knowledge base.
+  void UseStaffData(ScAddr const & restaurantAddr, StaffData const & data);
+
+  /*!
+   * Brings can_work arcs in line with current availability, forms shift slots and the flow network.
+   * Employee slots are not used by the solver and are written only for the debug graph.
+   * If the restaurant limits shifts per day, an employee with more candidate shifts on a day than
+   * the limit reaches them through a node of that day, whose single arc carries the limit.
+   */
+  void BuildFlowNetwork(bool generateDebugGraph = false);
+
+  /*!
+   * Finds maximal flow in the network with the given engine and returns number of matched shift slots.
+   * The decomposed engine splits shift demands by day of the shift, the preference engine prices
+   * assignments with GetPreferenceCosts. If the restaurant sets a minimum rest, assignments that break it
+   * are then dropped and forbidden, and the flow is completed again without regard to preferences.
+   * The engine is written to the schedule (nrel_schedule_solver), so that a repair can use it again.
+   */
+  size_t FindMaxFlow(ScheduleSolverType solverType = ScheduleSolverType::Dinic);
+
+  //! Writes assignments, reserves, staffing issues and employee schedules to the knowledge base.
+  ScStructure WriteSchedule();
+
+  /*!
+   * Reads a schedule written earlier by WriteSchedule and puts its assignments that are still valid
+   * into the network as initial flow; returns their number. Call after BuildFlowNetwork: FindMaxFlow
+   * then searches only for the missing flow. Without restoreFlow the network is left as is and
+   * the loaded assignments serve only for RepairSchedule to compare with.
+   */
+  size_t LoadSchedule(ScAddr const & scheduleAddr, bool restoreFlow = true);
+
+  //! Engine that found the schedule loaded by LoadSchedule; Dinic for a schedule that does not name one.
+  ScheduleSolverType GetLoadedSolverType() const;
+
+  //! Writes only the difference between the loaded schedule and the current flow.
+  ScStructure RepairSchedule();
+
+  /*!
+   * Writes the flow found by FindMaxFlow into the current schedule of the restaurant, changing
+   * only assignments that differ from it, so repeated builds do not add elements. Writes a new
+   * schedule if the restaurant has none.
+   */
+  ScStructure UpdateSchedule();
+
+  //! Attaches collected metrics to the schedule as JSON link content, replacing metrics of an earlier run.
+  void WriteMetrics(ScStructure & result);
+
+  std::vector<EmployeeInfo> const & GetEmployees() const;
+  std::vector<ShiftInfo> const & GetShifts() const;
+  size_t GetSlotCount() const;
+  //! Schedule written by WriteSchedule or loaded by LoadSchedule.
+  ScAddr GetScheduleAddr() const;
+  StaffScheduleMetrics const & GetMetrics() const;
+
+  //! Flow network formed by BuildFlowNetwork; residual capacities change after FindMaxFlow.
+  FlowNetwork const & GetNetwork() const;
+  size_t GetSource() const;
+  size_t GetSink() const;
+
+  /*!
+   * Part labels of network nodes for DecomposedMaxFlow: day plus one for demands, 0 otherwise. Day nodes of
+   * the daily limit are not labelled: such a network is not bipartite and DecomposedMaxFlow solves it with Dinic.
+   */
+  std::vector<size_t> GetDemandDayParts() const;
+
+  /*!
+   * Arc costs for WeightedMaxFlow: an assignment costs the strongest preference of the restaurant minus
+   * the preference of the employee for the shift type, other edges cost nothing.
+   */
+  std::vector<int> GetPreferenceCosts() const;
+
+private:
+  using ElementId = ScheduleResultWriter::ElementId;
+
+  //! Assignment or reserve arc of a loaded schedule; indices are NotFound if the shift or employee is gone.
+  struct LoadedAssignment
+  {
+    ScAddr arc;
+    size_t shiftIndex;
+    size_t employeeIndex;
+    //! Assignment is restored in the network, or reserve still fits the shift.
+    bool valid;
+  };
+
+  //! Elements of a schedule written earlier, found from its node by LoadSchedule.
+  struct LoadedSchedule
+  {
+    std::vector<LoadedAssignment> assignments;
+    std::vector<LoadedAssignment> reserves;
+    std::vector<ScAddr> issues;
+    //! Schedule arcs to shifts that are no longer scheduled.
+    std::vector<ScAddr> staleShiftArcs;
+    std::vector<char> hasShift;
+    //! Employee week schedules and shift count links by employee index, with the relation arcs to them.
+    std::vector<ScAddr> employeeSchedules;
+    std::vector<ScAddr> employeeScheduleArcs;
+    std::vector<ScAddr> shiftCountLinks;
+    std::vector<ScAddr> shiftCountArcs;
+    //! Week schedules and shift count links of employees that left the restaurant.
+    std::vector<ScAddr> staleEmployeeElements;
+    ScAddr staffedLink;
+    ScAddr deviationLink;
+    ScAddr solverArc;
+    ScheduleSolverType solverType = ScheduleSolverType::Dinic;
+  };
+
+  void ReadStaffPerEntity(std::vector<ScAddr> const & allShiftTypes);
+  void ReadStaffByRelations(std::vector<ScAddr> const & allShiftTypes);
+  //! Reads shifts of the restaurant (nrel_has_shift) or, if it has none, shifts that belong to no restaurant.
+  void ReadShifts();
+  /*!
+   * Reads staffing requirements of the restaurant, shift types and shifts and merges them into every shift;
+   * a more specific requirement replaces the one for the same role. A restaurant without requirements
+   * gets the default composition.
+   */
+  void ReadRequirements();
+  //! Requirements given by owner => nrel_staffing_requirement; later ones replace earlier ones of the same role.
+  void ReadRequirementsOf(ScAddr const & owner, std::vector<StaffRequirement> & requirements);
+  //! Assigns dense shift type and role indices and groups shifts and employees by them.
+  void IndexStaffData();
+  /*!
+   * Places days on the time axis along nrel_next_day: days without a previous day start chains, and
+   * unrelated chains are kept a day apart. If all days form one cycle, the week repeats.
+   */
+  void IndexDays();
+  //! Returns employees of the role available for the shift type, or nullptr if nobody has the role.
+  EmployeeBitset const * FindCandidates(ScAddr const & role, size_t shiftTypeIndex) const;
+  //! Returns assigned employees of every demand and updates assigned shifts of employees.
+  std::vector<std::vector<size_t>> CollectAssignments();
+  void AddStaffingIssues(
+      ScheduleResultWriter & writer,
+      ElementId schedule,
+      ElementId shift,
+      size_t shiftIndex,
+      std::vector<std::vector<size_t>> const & assignedPerDemand);
+  /*!
+   * Adds up to m_reserveCount reserves for every role of the shift: candidates not assigned to it,
+   * ranked by shifts left before their weekly limit. Returns the number of reserves added.
+   */
+  size_t AddReserves(
+      ScheduleResultWriter & writer,
+      ElementId schedule,
+      ElementId shift,
+      std::vector<ElementId> const & employeeIds,
+      size_t shiftIndex,
+      std::vector<std::vector<size_t>> const & assignedPerDemand);
+  void AddEmployeeSchedule(
+      ScheduleResultWriter & writer,
+      ElementId schedule,
+      ElementId employee,
+      std::vector<ElementId> const & shiftIds,
+      size_t employeeIndex);
+  /*!
+   * Searches the residual network from the source breadth-first: an employee is reachable if they
+   * have shifts left or can hand one of their shifts over along an alternating path; day nodes keep
+   * the daily limit on the path. Ranks reachable unassigned candidates of every demand by path length,
+   * then by shifts left of the path start. The minimum rest is not checked for substitutions.
+   */
+  void SearchAlternatingPaths();
+  //! Up to m_substituteCount best substitutes for the employee in the demand whose paths avoid both.
+  std::vector<size_t> FindSubstitutes(size_t demandIndex, size_t employeeIndex) const;
+  /*!
+   * Writes assignedArc => nrel_substitutes: tuple of ranked substitutions, each with the moves of its
+   * alternating path; call after SearchAlternatingPaths. Returns the number of substitutions.
+   */
+  size_t AddSubstitutes(
+      ScheduleResultWriter & writer,
+      ElementId assignedArc,
+      size_t demandIndex,
+      size_t employeeIndex,
+      std::vector<ElementId> const & shiftIds,
+      std::vector<ElementId> const & employeeIds);
+  //! Erases substitutions written for the assignment arc earlier.
+  void EraseSubstitutes(ScAddr const & assignedArc);
+  //! Shifts the employee can still take before the weekly limit, call after CollectAssignments.
+  size_t GetShiftsLeft(size_t employeeIndex) const;
+  //! Reads reserve and substitute counts and day rules of the restaurant, or takes defaults if they are not set.
+  void ReadScheduleSettings();
+  //! Reads restaurant => relation: [count]; returns defaultCount if it is missing or invalid.
+  size_t ReadRestaurantCount(ScAddr const & relation, size_t defaultCount);
+  //! Reads owner => relation: [count]; returns defaultCount if it is missing or invalid.
+  size_t ReadCount(ScAddr const & owner, ScAddr const & relation, size_t defaultCount);
+  //! Adds the preference given by the arc of nrel_preferred_shift_type unless the shift type is already preferred.
+  void AddPreference(EmployeeInfo & employee, ScAddr const & shiftType, ScAddr const & preferenceArc);
+  //! Standard deviation of shift counts of employees, call after CollectAssignments.
+  std::string GetShiftCountDeviation() const;
+  //! Sets content of the schedule link loaded earlier, or adds schedule => relation: link if there is none.
+  void UpdateScheduleLink(
+      ScheduleResultWriter & writer,
+      ElementId schedule,
+      ScAddr const & link,
+      ScAddr const & relation,
+      std::string const & content);
+  //! Pushes one unit of flow for the assignment if the network still allows it.
+  bool RestoreAssignment(size_t shiftIndex, size_t employeeIndex);
+  //! Node from which the employee reaches demands of the shift: their day node or the employee node itself.
+  size_t GetEntryNode(size_t employeeIndex, size_t shiftIndex) const;
+  //! Employee of an employee or day node, NotFound for other nodes.
+  size_t GetNodeEmployee(size_t node) const;
+  //! Employee has not reached the daily limit on the day of the shift.
+  bool HasDayLeft(size_t employeeIndex, size_t shiftIndex) const;
+  /*!
+   * Drops the later of two assignments of an employee that leave less than m_minRestHours between them,
+   * forbids its arc together with the free arcs of the employee to shifts too close to the kept ones and
+   * completes the flow with Dinic, until no such pair is left. Every round forbids at least one arc, so
+   * the number of rounds is bounded by the number of arcs; the result is maximal among flows without
+   * forbidden arcs, not among all flows that keep the rest.
+   */
+  void ResolveRestConflicts();
+  //! Schedule of the restaurant marked with nrel_current_schedule, or an empty address.
+  ScAddr FindCurrentSchedule();
+  /*!
+   * Adds missing can_work arcs and erases stale or duplicate ones, so repeated runs do not grow the graph.
+   * Arcs of employees that left the restaurant are erased when the restaurant owns its shifts, arcs to
+   * shifts that no other restaurant owns are erased always.
+   */
+  void GenerateCanWorkArcs();
+  void GenerateEmployeeSlots();
+
+  ScAddr GenerateNode(ScType const & type);
+  ScAddr GenerateConnector(ScType const & type, ScAddr const & source, ScAddr const & target);
+
+  template <typename... TArgs>
+  ScIterator3Ptr CreateIterator3(TArgs const &... args)
+  {
+    m_metrics.AddIteratorCalls();
+    return m_context.CreateIterator3(args...);
+  }
+
+  //! Calls action(source, target) for every common arc that belongs to the relation.
+  template <typename TAction>
+  void ForEachRelationPair(ScAddr const & relation, TAction && action)
+  {
+    ScIterator3Ptr it = CreateIterator3(relation, ScType::ConstPermPosArc, ScType::ConstCommonArc);
+    while (it->Next())
+    {
+      auto const [source, target] = m_context.GetConnectorIncidentElements(it->Get(2));
+      if constexpr (std::is_invocable_v<TAction, ScAddr const &, ScAddr const &, ScAddr const &>)
+        action(source, target, it->Get(2));
+      else
+        action(source, target);
+    }
+  }
+
+  template <typename... TArgs>
+  ScIterator5Ptr CreateIterator5(TArgs const &... args)
+  {
+    m_metrics.AddIteratorCalls();
+    return m_context.CreateIterator5(args...);
+  }
+
+  ScMemoryContext & m_context;
+  utils::ScLogger & m_logger;
+
+  StaffScheduleMetrics m_metrics;
+
+  ScAddr m_restaurantAddr;
+  ScAddr m_scheduleAddr;
+  std::vector<EmployeeInfo> m_employees;
+  std::vector<ShiftInfo> m_shifts;
+
+  ScAddrIndex m_shiftTypeIndex;
+  ScAddrIndex m_roleIndex;
+  ScAddrIndex m_shiftIndex;
+  ScAddrIndex m_employeeIndex;
+  //! Shift indices by shift type index.
+  std::vector<std::vector<size_t>> m_shiftsByType;
+  //! Availability matrix: employees available for each shift type.
+  std::vector<EmployeeBitset> m_typeEmployees;
+  //! Role matrix: employees of each role.
+  std::vector<EmployeeBitset> m_roleEmployees;
+  //! Employees of the role available for the shift type, by roleIndex * shift type count + shift type index.
+  std::vector<EmployeeBitset> m_candidates;
+  ScAddrIndex m_dayIndex;
+  //! Hour of the week at which each day starts.
+  std::vector<size_t> m_dayStartHour;
+  //! Length of the repeating week in hours, or 0 if days do not form a cycle.
+  size_t m_weekHours = 0;
+
+  std::vector<ShiftDemand> m_demands;
+  //! Demands of shift j are [m_shiftDemandStart[j], m_shiftDemandStart[j + 1]).
+  std::vector<size_t> m_shiftDemandStart;
+  size_t m_slotCount = 0;
+
+  FlowNetwork m_network;
+  size_t m_demandStart = 0;
+  size_t m_source = 0;
+  size_t m_sink = 0;
+  //! Edges from demands to the sink start here, one per demand.
+  size_t m_sinkEdgeStart = 0;
+  //! Day nodes follow the sink, edges from employees to them follow the source edges.
+  size_t m_dayNodeStart = 0;
+  size_t m_dayEdgeStart = 0;
+  std::vector<size_t> m_dayNodeEmployee;
+  //! Day node by employee index * day count + day index, NotFound if the employee reaches demands directly.
+  std::vector<size_t> m_employeeDayNode;
+  size_t m_flow = 0;
+  ScheduleSolverType m_solverType = ScheduleSolverType::Dinic;
+
+  static constexpr size_t DefaultReserveCount = 1;
+  //! Reserves per role of a shift.
+  size_t m_reserveCount = DefaultReserveCount;
+  //! Substitutes are written only when the restaurant asks for them.
+  static constexpr size_t DefaultSubstituteCount = 0;
+  //! Substitutes per assignment.
+  size_t m_substituteCount = DefaultSubstituteCount;
+  //! Shifts of an employee per day, 0 if there is no limit.
+  size_t m_maxShiftsPerDay = 0;
+  //! Hours between the end of a shift and the start of the next shift of the employee, 0 if there is no limit.
+  size_t m_minRestHours = 0;
+  //! Parents of network nodes on alternating paths from the source, found by SearchAlternatingPaths.
+  std::vector<size_t> m_pathParent;
+  //! Employees on the alternating path to each employee or day node, 0 if the node is not reachable.
+  std::vector<size_t> m_pathEmployees;
+  //! Employee and day nodes reachable by alternating paths, best substitutes first.
+  std::vector<size_t> m_rankedNodes;
+  //! Unassigned candidates of each demand as positions in m_rankedNodes.
+  std::vector<EmployeeBitset> m_substituteCandidates;
+
+  LoadedSchedule m_loadedSchedule;
+};
@@ -0,0 +1,163 @@
+#include "staff_data_cache.hpp"
+
+#include <sc-memory/sc_event.hpp>
+#include <sc-memory/sc_iterator.hpp>
+
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+using namespace std;
+
+template <typename TScEvent>
+void StaffDataCache::SubscribeTo(ScAddr const & element)
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_subscriptions.push_back(m_context->CreateElementaryEventSubscription<TScEvent>(
+      element,
+      [this](TScEvent const &) {
+        Invalidate();
+      }));
+}
+
+void StaffDataCache::SubscribeToLinkOf(ScAddr const & relationArc)
+{
+  ScAddr const linkAddr = m_context->GetArcTargetElement(relationArc);
+  if (!m_context->GetElementType(linkAddr).IsLink())
+    return;
+
+  lock_guard<mutex> lock(m_mutex);
+  if (!m_enabled || !m_links.insert(linkAddr).second)
+    return;
+  m_subscriptions.push_back(m_context->CreateElementaryEventSubscription<ScEventChangeLinkContent>(
+      linkAddr,
+      [this](ScEventChangeLinkContent const &) {
+        Invalidate();
+      }));
+}
+
+void StaffDataCache::SubscribeToLinks(ScAddr const & relation)
+{
+  ScIterator3Ptr itArcs = m_context->CreateIterator3(relation, ScType::ConstPermPosArc, ScType::ConstCommonArc);
+  while (itArcs->Next())
+    SubscribeToLinkOf(itArcs->Get(2));
+
+  lock_guard<mutex> lock(m_mutex);
+  m_subscriptions.push_back(
+      m_context->CreateElementaryEventSubscription<ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc>>(
+          relation,
+          [this](ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc> const & event) {
+            Invalidate();
+            SubscribeToLinkOf(event.GetArcTargetElement());
+          }));
+}
+
+void StaffDataCache::Subscribe()
+{
+  Unsubscribe();
+  m_context = make_unique<ScAgentContext>();
+  // Кэш включается до подписок, чтобы обработчики новых ссылок могли подписываться уже во время настройки.
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_enabled = true;
+  }
+
+  // Данные ресторана зависят от этих отношений и классов; любая добавленная или удалённая
+  // принадлежность сбрасывает кэш.
+  for (ScAddr const & element :
+       {StaffScheduleKeynodes::nrel_has_employee,
+        StaffScheduleKeynodes::nrel_has_shift,
+        StaffScheduleKeynodes::nrel_has_role,
+        StaffScheduleKeynodes::nrel_available_shift_type,
+        StaffScheduleKeynodes::nrel_preferred_shift_type,
+        StaffScheduleKeynodes::nrel_shift_type,
+        StaffScheduleKeynodes::nrel_shift_day,
+        StaffScheduleKeynodes::nrel_next_day,
+        StaffScheduleKeynodes::nrel_staffing_requirement,
+        StaffScheduleKeynodes::nrel_required_role,
+        StaffScheduleKeynodes::concept_shift,
+        StaffScheduleKeynodes::concept_shift_type})
+  {
+    SubscribeTo<ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc>>(element);
+    SubscribeTo<ScEventBeforeEraseOutgoingArc<ScType::ConstPermPosArc>>(element);
+  }
+
+  // Числа хранятся в ссылках, и их содержимое меняют без новых дуг: на каждую ссылку этих отношений,
+  // в том числе добавленную позже, подписываемся отдельно.
+  for (ScAddr const & relation :
+       {StaffScheduleKeynodes::nrel_preference_weight,
+        StaffScheduleKeynodes::nrel_max_shifts_per_week,
+        StaffScheduleKeynodes::nrel_start_hour,
+        StaffScheduleKeynodes::nrel_end_hour,
+        StaffScheduleKeynodes::nrel_required_count})
+  {
+    SubscribeToLinks(relation);
+    SubscribeTo<ScEventBeforeEraseOutgoingArc<ScType::ConstPermPosArc>>(relation);
+  }
+}
+
+void StaffDataCache::Unsubscribe()
+{
+  vector<shared_ptr<ScEventSubscription>> subscriptions;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_enabled = false;
+    subscriptions.swap(m_subscriptions);
+    m_links.clear();
+    m_data.clear();
+    ++m_version;
+  }
+  // Подписки удаляются без блокировки: их обработчики сами берут мьютекс.
+  subscriptions.clear();
+  m_context.reset();
+}
+
+bool StaffDataCache::IsEnabled() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_enabled;
+}
+
+shared_ptr<StaffData const> StaffDataCache::Find(ScAddr const & restaurantAddr) const
+{
+  lock_guard<mutex> lock(m_mutex);
+  auto const it = m_data.find(restaurantAddr);
+  return it == m_data.end() ? nullptr : it->second;
+}
+
+size_t StaffDataCache::GetVersion() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_version;
+}
+
+void StaffDataCache::Store(ScAddr const & restaurantAddr, size_t version, shared_ptr<StaffData const> data)
+{
+  lock_guard<mutex> lock(m_mutex);
+  if (!m_enabled || version != m_version)
+    return;
+  m_data[restaurantAddr] = move(data);
+}
+
+void StaffDataCache::Invalidate()
+{
+  lock_guard<mutex> lock(m_mutex);
+  m_data.clear();
+  ++m_version;
+}
+
+void StaffDataCache::Read(StaffScheduleBuilder & builder, ScAddr const & restaurantAddr)
+{
+  if (shared_ptr<StaffData const> cached = Find(restaurantAddr))
+  {
+    builder.UseStaffData(restaurantAddr, *cached);
+    return;
+  }
+
+  // Версия берётся до чтения: если база изменится во время чтения, прочитанное не попадёт в кэш.
+  size_t const version = GetVersion();
+  builder.ReadStaffData(restaurantAddr);
+  if (IsEnabled())
+  {
+    auto data = make_shared<StaffData const>(StaffData{builder.GetEmployees(), builder.GetShifts()});
+    Store(restaurantAddr, version, move(data));
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <sc-memory/sc_agent_context.hpp>
+#include <sc-memory/sc_event_subscription.hpp>
+
+#include "builder/staff_schedule_builder.hpp"
+#include "model/staff_schedule_model.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*!
+ * Staff data of restaurants read by previous schedule builds. Works only while subscribed:
+ * any change of employees, roles, availability, limits, shifts, shift types, days or staffing requirements
+ * drops the data and increments the version, so a read started before the change is not stored.
+ * Limits, preference weights, hours and required counts are links, so changes of their content count too.
+ */
+class StaffDataCache
+{
+public:
+  //! Subscribes to changes of the staff relations and enables the cache.
+  void Subscribe();
+
+  //! Drops subscriptions and cached data and disables the cache.
+  void Unsubscribe();
+
+  bool IsEnabled() const;
+
+  //! Returns cached data of the restaurant, or nullptr.
+  std::shared_ptr<StaffData const> Find(ScAddr const & restaurantAddr) const;
+
+  //! Version to pass to Store; take it before reading the knowledge base.
+  size_t GetVersion() const;
+
+  //! Stores data read at the given version; ignored if the knowledge base has changed since then.
+  void Store(ScAddr const & restaurantAddr, size_t version, std::shared_ptr<StaffData const> data);
+
+  void Invalidate();
+
+  //! Gives the builder cached data of the restaurant, or reads it and caches it.
+  void Read(StaffScheduleBuilder & builder, ScAddr const & restaurantAddr);
+
+private:
+  template <typename TScEvent>
+  void SubscribeTo(ScAddr const & element);
+
+  //! Subscribes to new arcs of a relation with link targets and to content changes of every such link.
+  void SubscribeToLinks(ScAddr const & relation);
+  void SubscribeToLinkOf(ScAddr const & relationArc);
+
+  mutable std::mutex m_mutex;
+  std::unique_ptr<ScAgentContext> m_context;
+  std::vector<std::shared_ptr<ScEventSubscription>> m_subscriptions;
+  std::unordered_set<ScAddr, ScAddrHashFunc> m_links;
+  std::unordered_map<ScAddr, std::shared_ptr<StaffData const>, ScAddrHashFunc> m_data;
+  size_t m_version = 0;
+  bool m_enabled = false;
+};
@@ -7,6 +7,12 @@ class StaffScheduleKeynodes : public ScKeynodes
 public:
   static inline ScKeynode const action_build_staff_schedule{
       "action_build_staff_schedule", ScType::ConstNodeClass};
+  static inline ScKeynode const action_batch_build_staff_schedule{
+      "action_batch_build_staff_schedule", ScType::ConstNodeClass};
+  static inline ScKeynode const action_repair_staff_schedule{
+      "action_repair_staff_schedule", ScType::ConstNodeClass};
+  static inline ScKeynode const action_find_substitute{
+      "action_find_substitute", ScType::ConstNodeClass};
 
   static inline ScKeynode const concept_employee{
       "concept_employee", ScType::ConstNodeClass};
@@ -22,6 +28,10 @@ public:
       "concept_employee_slot", ScType::ConstNodeClass};
   static inline ScKeynode const concept_staffing_issue{
       "concept_staffing_issue", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_substitution{
+      "concept_substitution", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_staffing_requirement{
+      "concept_staffing_requirement", ScType::ConstNodeClass};
   static inline ScKeynode const concept_cook{
       "concept_cook", ScType::ConstNodeClass};
   static inline ScKeynode const concept_waiter{
@@ -30,11 +40,29 @@ public:
       "concept_cleaner", ScType::ConstNodeClass};
   static inline ScKeynode const concept_admin{
       "concept_admin", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_solver_dinic{
+      "concept_solver_dinic", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_solver_hopcroft_karp{
+      "concept_solver_hopcroft_karp", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_solver_push_relabel{
+      "concept_solver_push_relabel", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_solver_decomposed{
+      "concept_solver_decomposed", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_solver_min_cost{
+      "concept_solver_min_cost", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_solver_preference{
+      "concept_solver_preference", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_schedule_debug_graph{
+      "concept_schedule_debug_graph", ScType::ConstNodeClass};
+  static inline ScKeynode const concept_schedule_update_in_place{
+      "concept_schedule_update_in_place", ScType::ConstNodeClass};
 
   static inline ScKeynode const nrel_has_role{
       "nrel_has_role", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_has_employee{
       "nrel_has_employee", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_has_shift{
+      "nrel_has_shift", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_employee_slot{
       "nrel_employee_slot", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_slot_can_work{
@@ -47,24 +75,68 @@ public:
       "nrel_missing_shift", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_available_shift_type{
       "nrel_available_shift_type", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_preferred_shift_type{
+      "nrel_preferred_shift_type", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_preference_weight{
+      "nrel_preference_weight", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_shift_type{
       "nrel_shift_type", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_shift_day{
       "nrel_shift_day", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_next_day{
+      "nrel_next_day", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_start_hour{
+      "nrel_start_hour", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_end_hour{
+      "nrel_end_hour", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_staffing_requirement{
+      "nrel_staffing_requirement", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_required_role{
+      "nrel_required_role", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_required_count{
+      "nrel_required_count", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_assigned_employee{
       "nrel_assigned_employee", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_reserve_employee{
       "nrel_reserve_employee", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_reserve_count{
+      "nrel_reserve_count", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_substitutes{
+      "nrel_substitutes", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_substitute{
+      "nrel_substitute", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_substitute_count{
+      "nrel_substitute_count", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_max_shifts_per_day{
+      "nrel_max_shifts_per_day", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_min_rest_hours{
+      "nrel_min_rest_hours", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_moved_employee{
+      "nrel_moved_employee", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_from_shift{
+      "nrel_from_shift", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_to_shift{
+      "nrel_to_shift", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_can_work{
       "nrel_can_work", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_employee_schedule{
       "nrel_employee_schedule", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_shift_count{
       "nrel_shift_count", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_shift_count_deviation{
+      "nrel_shift_count_deviation", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_max_shifts_per_week{
       "nrel_max_shifts_per_week", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_all_shifts_staffed{
       "nrel_all_shifts_staffed", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_schedule_metrics{
+      "nrel_schedule_metrics", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_schedule_solver{
+      "nrel_schedule_solver", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_schedule_error{
+      "nrel_schedule_error", ScType::ConstNodeNonRole};
+  static inline ScKeynode const nrel_current_schedule{
+      "nrel_current_schedule", ScType::ConstNodeNonRole};
   static inline ScKeynode const nrel_main_idtf{
       "nrel_main_idtf", ScType::ConstNodeNonRole};
 };
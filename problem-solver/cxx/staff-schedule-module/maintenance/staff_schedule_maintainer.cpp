@@ -0,0 +1,216 @@
+#include "staff_schedule_maintainer.hpp"
+
+#include <sc-memory/sc_event.hpp>
+#include <sc-memory/sc_iterator.hpp>
+
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+StaffScheduleMaintainer::~StaffScheduleMaintainer()
+{
+  Stop();
+}
+
+template <typename TScEvent>
+void StaffScheduleMaintainer::SubscribeTo(ScAddr const & relation)
+{
+  m_subscriptions.push_back(m_context->CreateElementaryEventSubscription<TScEvent>(
+      relation,
+      [this, relation](TScEvent const & event) {
+        for (ScAddr const & restaurantAddr : FindRestaurants(relation, event.GetArcTargetElement()))
+          MarkChanged(restaurantAddr);
+      }));
+}
+
+void StaffScheduleMaintainer::Start(Duration debounce, Duration maxDelay)
+{
+  Stop();
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_debounce = debounce;
+    m_maxDelay = max(maxDelay, debounce);
+    m_repairCount = 0;
+    m_running = true;
+    m_thread = thread(&StaffScheduleMaintainer::Run, this);
+  }
+
+  // Событие сразу отмечает ресторан: действие на каждую правку копилось бы в базе при массовом импорте.
+  m_context = make_unique<ScAgentContext>();
+  for (ScAddr const & relation :
+       {StaffScheduleKeynodes::nrel_has_employee,
+        StaffScheduleKeynodes::nrel_has_shift,
+        StaffScheduleKeynodes::nrel_available_shift_type,
+        StaffScheduleKeynodes::nrel_max_shifts_per_week,
+        StaffScheduleKeynodes::nrel_staffing_requirement})
+  {
+    SubscribeTo<ScEventAfterGenerateOutgoingArc<ScType::ConstPermPosArc>>(relation);
+    SubscribeTo<ScEventBeforeEraseOutgoingArc<ScType::ConstPermPosArc>>(relation);
+  }
+}
+
+void StaffScheduleMaintainer::Stop()
+{
+  // Подписки удаляются до остановки потока и без блокировки: их обработчики сами берут мьютекс.
+  m_subscriptions.clear();
+  m_context.reset();
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_running = false;
+  }
+  m_changed.notify_all();
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+bool StaffScheduleMaintainer::IsRunning() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_running;
+}
+
+void StaffScheduleMaintainer::MarkChanged(ScAddr const & restaurantAddr)
+{
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (!m_running)
+      return;
+
+    auto const now = chrono::steady_clock::now();
+    if (m_pending.empty())
+      m_firstChange = now;
+    m_lastChange = now;
+    m_pending.insert(restaurantAddr);
+  }
+  m_changed.notify_all();
+}
+
+size_t StaffScheduleMaintainer::GetRepairCount() const
+{
+  lock_guard<mutex> lock(m_mutex);
+  return m_repairCount;
+}
+
+vector<ScAddr> StaffScheduleMaintainer::FindRestaurants(ScAddr const & relation, ScAddr const & pairArc)
+{
+  ScAgentContext & context = *m_context;
+  vector<ScAddr> restaurants;
+  if (!context.IsElement(pairArc) || !context.GetElementType(pairArc).IsConnector())
+    return restaurants;
+
+  auto const hasCurrentSchedule = [&](ScAddr const & restaurantAddr) {
+    ScIterator5Ptr it = context.CreateIterator5(
+        restaurantAddr,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_current_schedule);
+    return it->Next();
+  };
+
+  auto const addOwners = [&](ScAddr const & element, ScAddr const & ownerRelation) {
+    ScIterator5Ptr itRestaurant = context.CreateIterator5(
+        ScType::ConstNode,
+        ScType::ConstCommonArc,
+        element,
+        ScType::ConstPermPosArc,
+        ownerRelation);
+    while (itRestaurant->Next())
+    {
+      ScAddr const & restaurantAddr = itRestaurant->Get(0);
+      if (find(restaurants.begin(), restaurants.end(), restaurantAddr) == restaurants.end()
+          && hasCurrentSchedule(restaurantAddr))
+        restaurants.push_back(restaurantAddr);
+    }
+  };
+
+  // Сотрудники и смены принадлежат ресторану напрямую, остальные отношения задаются для сотрудника.
+  ScAddr const source = context.GetArcSourceElement(pairArc);
+  if (relation == StaffScheduleKeynodes::nrel_has_employee || relation == StaffScheduleKeynodes::nrel_has_shift)
+  {
+    if (hasCurrentSchedule(source))
+      restaurants.push_back(source);
+    return restaurants;
+  }
+
+  // Требования задаются для ресторана, смены или типа смены; для типа ищутся рестораны его смен.
+  if (relation == StaffScheduleKeynodes::nrel_staffing_requirement)
+  {
+    if (hasCurrentSchedule(source))
+      restaurants.push_back(source);
+    addOwners(source, StaffScheduleKeynodes::nrel_has_shift);
+
+    ScIterator5Ptr itShift = context.CreateIterator5(
+        ScType::ConstNode,
+        ScType::ConstCommonArc,
+        source,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_shift_type);
+    while (itShift->Next())
+      addOwners(itShift->Get(0), StaffScheduleKeynodes::nrel_has_shift);
+    return restaurants;
+  }
+
+  addOwners(source, StaffScheduleKeynodes::nrel_has_employee);
+  return restaurants;
+}
+
+void StaffScheduleMaintainer::Run()
+{
+  unique_lock<mutex> lock(m_mutex);
+  while (true)
+  {
+    m_changed.wait(lock, [&] {
+      return !m_running || !m_pending.empty();
+    });
+
+    // Ждём, пока изменения не прекратятся, но не дольше максимальной задержки от первого из них.
+    while (m_running)
+    {
+      auto const due = min(m_lastChange + m_debounce, m_firstChange + m_maxDelay);
+      if (chrono::steady_clock::now() >= due)
+        break;
+      m_changed.wait_until(lock, due);
+    }
+
+    // При остановке несделанные исправления отбрасываются: агент исправления может быть уже отписан.
+    if (!m_running)
+    {
+      m_pending.clear();
+      return;
+    }
+
+    vector<ScAddr> restaurants(m_pending.begin(), m_pending.end());
+    m_pending.clear();
+    lock.unlock();
+
+    size_t repaired = 0;
+    for (ScAddr const & restaurantAddr : restaurants)
+      repaired += Repair(restaurantAddr) ? 1 : 0;
+
+    lock.lock();
+    m_repairCount += repaired;
+  }
+}
+
+bool StaffScheduleMaintainer::Repair(ScAddr const & restaurantAddr)
+{
+  ScAgentContext context;
+  ScIterator5Ptr itSchedule = context.CreateIterator5(
+      restaurantAddr,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  if (!itSchedule->Next())
+    return false;
+
+  ScAction action = context.GenerateAction(StaffScheduleKeynodes::action_repair_staff_schedule);
+  action.SetArguments(restaurantAddr, itSchedule->Get(2));
+  return action.InitiateAndWait();
+}
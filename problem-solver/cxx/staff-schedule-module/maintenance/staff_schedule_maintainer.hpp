@@ -0,0 +1,66 @@
+#pragma once
+
+#include <sc-memory/sc_addr.hpp>
+#include <sc-memory/sc_agent_context.hpp>
+#include <sc-memory/sc_event_subscription.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/*!
+ * Keeps current schedules of restaurants up to date after staff changes. While running it listens to
+ * membership arcs added to or erased from nrel_has_employee, nrel_has_shift, nrel_available_shift_type,
+ * nrel_max_shifts_per_week and nrel_staffing_requirement, without creating an action per event.
+ * Changes are collected until no new one comes for the debounce interval (or the maximum delay passes),
+ * then every changed restaurant gets one action_repair_staff_schedule for its nrel_current_schedule.
+ */
+class StaffScheduleMaintainer
+{
+public:
+  using Duration = std::chrono::milliseconds;
+
+  ~StaffScheduleMaintainer();
+
+  //! Subscribes to staff changes and starts the repair thread; changes are ignored while it is not running.
+  void Start(Duration debounce = Duration(500), Duration maxDelay = Duration(5000));
+
+  //! Unsubscribes and stops the thread; changes that are not repaired yet are dropped.
+  void Stop();
+
+  bool IsRunning() const;
+
+  //! Schedules repair of the current schedule of the restaurant.
+  void MarkChanged(ScAddr const & restaurantAddr);
+
+  //! Number of repair actions completed since start.
+  size_t GetRepairCount() const;
+
+private:
+  template <typename TScEvent>
+  void SubscribeTo(ScAddr const & relation);
+  //! Restaurants with a current schedule that the changed relation pair concerns.
+  std::vector<ScAddr> FindRestaurants(ScAddr const & relation, ScAddr const & pairArc);
+
+  void Run();
+  //! Initiates repair of the current schedule of the restaurant; false if it has none.
+  bool Repair(ScAddr const & restaurantAddr);
+
+  std::unique_ptr<ScAgentContext> m_context;
+  std::vector<std::shared_ptr<ScEventSubscription>> m_subscriptions;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::thread m_thread;
+  std::unordered_set<ScAddr, ScAddrHashFunc> m_pending;
+  std::chrono::steady_clock::time_point m_firstChange;
+  std::chrono::steady_clock::time_point m_lastChange;
+  Duration m_debounce{0};
+  Duration m_maxDelay{0};
+  size_t m_repairCount = 0;
+  bool m_running = false;
+};
@@ -0,0 +1,87 @@
+#include "staff_schedule_metrics.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+StaffScheduleMetrics::PhaseScope::PhaseScope(StaffScheduleMetrics & metrics, std::string const & name)
+  : m_metrics(metrics)
+  , m_phaseIndex(metrics.m_phases.size())
+  , m_enclosingPhase(metrics.m_currentPhase)
+  , m_start(std::chrono::steady_clock::now())
+{
+  Phase phase;
+  phase.name = name;
+  m_metrics.m_phases.push_back(phase);
+  m_metrics.m_currentPhase = m_phaseIndex;
+}
+
+StaffScheduleMetrics::PhaseScope::~PhaseScope()
+{
+  auto const end = std::chrono::steady_clock::now();
+  m_metrics.m_phases[m_phaseIndex].durationMs =
+      std::chrono::duration<double, std::milli>(end - m_start).count();
+  m_metrics.m_currentPhase = m_enclosingPhase;
+}
+
+void StaffScheduleMetrics::AddElements(size_t count)
+{
+  if (Phase * phase = GetCurrentPhase())
+    phase->elementsCreated += count;
+}
+
+void StaffScheduleMetrics::AddIteratorCalls(size_t count)
+{
+  if (Phase * phase = GetCurrentPhase())
+    phase->iteratorCalls += count;
+}
+
+void StaffScheduleMetrics::AddCounter(std::string const & name, size_t value)
+{
+  Phase * phase = GetCurrentPhase();
+  if (phase == nullptr)
+    return;
+
+  for (auto & counter : phase->counters)
+  {
+    if (counter.first == name)
+    {
+      counter.second += value;
+      return;
+    }
+  }
+  phase->counters.emplace_back(name, value);
+}
+
+std::vector<StaffScheduleMetrics::Phase> const & StaffScheduleMetrics::GetPhases() const
+{
+  return m_phases;
+}
+
+std::string StaffScheduleMetrics::ToJson() const
+{
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  stream << "{\"phases\":[";
+  for (size_t i = 0; i < m_phases.size(); ++i)
+  {
+    Phase const & phase = m_phases[i];
+    if (i > 0)
+      stream << ",";
+    stream << "{\"name\":\"" << phase.name << "\""
+           << ",\"duration_ms\":" << phase.durationMs
+           << ",\"elements\":" << phase.elementsCreated
+           << ",\"iterators\":" << phase.iteratorCalls;
+    for (auto const & counter : phase.counters)
+      stream << ",\"" << counter.first << "\":" << counter.second;
+    stream << "}";
+  }
+  stream << "]}";
+  return stream.str();
+}
+
+StaffScheduleMetrics::Phase * StaffScheduleMetrics::GetCurrentPhase()
+{
+  if (m_currentPhase == NoPhase)
+    return nullptr;
+  return &m_phases[m_currentPhase];
+}
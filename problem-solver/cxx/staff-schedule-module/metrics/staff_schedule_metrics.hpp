@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+ * Collects duration, number of generated sc-elements and number of created sc-iterators
+ * for every stage of staff schedule building. Additional per-stage counters (for example,
+ * number of Dinic rounds) can be attached to the current stage.
+ */
+class StaffScheduleMetrics
+{
+public:
+  struct Phase
+  {
+    std::string name;
+    double durationMs = 0;
+    size_t elementsCreated = 0;
+    size_t iteratorCalls = 0;
+    std::vector<std::pair<std::string, size_t>> counters;
+  };
+
+  class PhaseScope
+  {
+  public:
+    PhaseScope(StaffScheduleMetrics & metrics, std::string const & name);
+    PhaseScope(PhaseScope const &) = delete;
+    PhaseScope & operator=(PhaseScope const &) = delete;
+    ~PhaseScope();
+
+  private:
+    StaffScheduleMetrics & m_metrics;
+    size_t m_phaseIndex;
+    size_t m_enclosingPhase;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  //! Counts generated sc-elements in the current stage.
+  void AddElements(size_t count = 1);
+
+  //! Counts created sc-iterators in the current stage.
+  void AddIteratorCalls(size_t count = 1);
+
+  //! Adds value to the named counter of the current stage.
+  void AddCounter(std::string const & name, size_t value = 1);
+
+  std::vector<Phase> const & GetPhases() const;
+
+  //! Returns metrics as one line of JSON.
+  std::string ToJson() const;
+
+private:
+  static size_t const NoPhase = static_cast<size_t>(-1);
+
+  Phase * GetCurrentPhase();
+
+  std::vector<Phase> m_phases;
+  //! Stage that receives counters; a nested stage returns it to the enclosing one when it ends.
+  size_t m_currentPhase = NoPhase;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * Set of employee indices packed into 64-bit words: bit i is the employee with index i.
+ * Set operations work a word at a time; loops are plain enough for the compiler to vectorise.
+ */
+class EmployeeBitset
+{
+public:
+  explicit EmployeeBitset(size_t size = 0)
+    : m_size(size)
+    , m_words((size + 63) / 64, 0)
+  {
+  }
+
+  size_t GetSize() const
+  {
+    return m_size;
+  }
+
+  void Set(size_t index)
+  {
+    m_words[index / 64] |= uint64_t(1) << (index % 64);
+  }
+
+  bool Test(size_t index) const
+  {
+    return (m_words[index / 64] >> (index % 64)) & 1;
+  }
+
+  //! Number of employees in the set.
+  size_t Count() const
+  {
+    size_t count = 0;
+    for (uint64_t word : m_words)
+      count += static_cast<size_t>(__builtin_popcountll(word));
+    return count;
+  }
+
+  EmployeeBitset & operator&=(EmployeeBitset const & other)
+  {
+    for (size_t i = 0; i < m_words.size(); ++i)
+      m_words[i] &= other.m_words[i];
+    return *this;
+  }
+
+  //! Calls action for every index in the set in increasing order.
+  template <typename TAction>
+  void ForEach(TAction && action) const
+  {
+    for (size_t i = 0; i < m_words.size(); ++i)
+    {
+      uint64_t word = m_words[i];
+      while (word != 0)
+      {
+        action(i * 64 + static_cast<size_t>(__builtin_ctzll(word)));
+        word &= word - 1;
+      }
+    }
+  }
+
+  //! Calls action for every index that is in this set and not in excluded, in increasing order.
+  template <typename TAction>
+  void ForEachNotIn(EmployeeBitset const & excluded, TAction && action) const
+  {
+    for (size_t i = 0; i < m_words.size(); ++i)
+    {
+      uint64_t word = m_words[i] & ~excluded.m_words[i];
+      while (word != 0)
+      {
+        action(i * 64 + static_cast<size_t>(__builtin_ctzll(word)));
+        word &= word - 1;
+      }
+    }
+  }
+
+private:
+  size_t m_size;
+  std::vector<uint64_t> m_words;
+};
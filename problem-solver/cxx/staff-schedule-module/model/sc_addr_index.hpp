@@ -0,0 +1,53 @@
+#pragma once
+
+#include <sc-memory/sc_addr.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * Maps sc-addrs to dense indices 0, 1, 2, ... in order of addition, so that
+ * per-element data can be kept in vectors and bitsets instead of searched lists.
+ */
+class ScAddrIndex
+{
+public:
+  static constexpr size_t NotFound = std::numeric_limits<size_t>::max();
+
+  //! Returns index of the addr, adding it if it is new.
+  size_t Add(ScAddr const & addr)
+  {
+    auto const [it, added] = m_indices.emplace(addr, m_addrs.size());
+    if (added)
+      m_addrs.push_back(addr);
+    return it->second;
+  }
+
+  size_t Find(ScAddr const & addr) const
+  {
+    auto const it = m_indices.find(addr);
+    return it == m_indices.end() ? NotFound : it->second;
+  }
+
+  ScAddr const & GetAddr(size_t index) const
+  {
+    return m_addrs[index];
+  }
+
+  size_t GetSize() const
+  {
+    return m_addrs.size();
+  }
+
+  void Clear()
+  {
+    m_indices.clear();
+    m_addrs.clear();
+  }
+
+private:
+  std::unordered_map<ScAddr, size_t, ScAddrHashFunc> m_indices;
+  std::vector<ScAddr> m_addrs;
+};
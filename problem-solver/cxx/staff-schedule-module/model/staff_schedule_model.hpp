@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sc-memory/sc_addr.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+//! Shift type that an employee prefers (employee => nrel_preferred_shift_type) and the weight of the preference.
+struct ShiftPreference
+{
+  //! Weights above it are clamped: preference costs index distance buckets of WeightedMaxFlow.
+  static constexpr int MaxWeight = 100;
+
+  ScAddr shiftType;
+  int weight;
+};
+
+struct EmployeeInfo
+{
+  ScAddr addr;
+  ScAddr role;
+  size_t roleIndex = 0;
+  std::vector<ScAddr> availableShiftTypes;
+  std::vector<ShiftPreference> preferredShiftTypes;
+  size_t assignedCount = 0;
+  size_t maxShifts = 5;
+  std::vector<ScAddr> assignedShifts;
+};
+
+//! Number of employees of one role that a shift needs.
+struct StaffRequirement
+{
+  ScAddr role;
+  size_t count;
+};
+
+struct ShiftInfo
+{
+  static constexpr size_t NoHour = std::numeric_limits<size_t>::max();
+
+  ScAddr addr;
+  ScAddr shiftType;
+  size_t shiftTypeIndex = 0;
+  ScAddr day;
+  //! Day that follows the day of the shift (day => nrel_next_day), if it is given.
+  ScAddr nextDay;
+  //! Dense index of the day assigned by the builder, ScAddrIndex::NotFound if the shift has no day.
+  size_t dayIndex = 0;
+  //! Hours of the shift type from 0 to 24, or NoHour; a shift that does not end after it starts ends next day.
+  size_t startHour = NoHour;
+  size_t endHour = NoHour;
+  //! Requirements of the restaurant, the shift type and the shift merged by role; zero counts are kept.
+  std::vector<StaffRequirement> requirements;
+};
+
+//! Number of employees of one role required in one shift.
+struct ShiftDemand
+{
+  size_t shiftIndex;
+  ScAddr role;
+  size_t count;
+};
+
+//! Employees and shifts of one restaurant as read from the knowledge base, before any assignment.
+struct StaffData
+{
+  std::vector<EmployeeInfo> employees;
+  std::vector<ShiftInfo> shifts;
+};
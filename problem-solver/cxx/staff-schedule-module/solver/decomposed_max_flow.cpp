@@ -0,0 +1,265 @@
+#include "decomposed_max_flow.hpp"
+
+#include "solver/run_on_new_threads.hpp"
+
+#include <limits>
+#include <map>
+#include <numeric>
+
+namespace
+{
+size_t const NoIndex = std::numeric_limits<size_t>::max();
+
+size_t FindRoot(std::vector<size_t> & parent, size_t node)
+{
+  while (parent[node] != node)
+  {
+    parent[node] = parent[parent[node]];
+    node = parent[node];
+  }
+  return node;
+}
+}  // namespace
+
+DecomposedMaxFlow::DecomposedMaxFlow(std::vector<size_t> nodeParts)
+  : m_nodeParts(std::move(nodeParts))
+{
+}
+
+int DecomposedMaxFlow::Solve(FlowNetwork & network, size_t source, size_t sink)
+{
+  m_parts.clear();
+  m_threads = 0;
+  m_partFlow = 0;
+  m_sharedLeft = false;
+  m_hadFlow = false;
+  m_usedFallback = !ReadBipartiteLayer(network, source, sink);
+  if (m_usedFallback)
+    return m_rebalance.Solve(network, source, sink);
+
+  SplitIntoParts(network);
+  DivideLeftCapacities(network, source);
+
+  // Каждая часть строит и решает свою сеть, общая сеть в это время только читается.
+  m_threads = RunOnNewThreads(m_parts.size(), [&](size_t p) {
+    SolvePart(network, m_parts[p]);
+  });
+
+  int flow = 0;
+  for (Part const & part : m_parts)
+  {
+    for (size_t edge = 0; edge < part.arcs.size(); ++edge)
+    {
+      int const edgeFlow = part.network.GetEdgeFlow(edge);
+      if (edgeFlow > 0)
+        network.Push(part.arcs[edge], edgeFlow);
+    }
+    flow += part.flow;
+  }
+  m_partFlow = static_cast<size_t>(flow);
+
+  // Части без общих сотрудников независимы, и их потоки уже максимальны, если сеть была пустой.
+  if (!m_sharedLeft && !m_hadFlow)
+    return flow;
+
+  // Доли лимитов могли быть разделены неудачно: дополняющие пути по всей сети перераспределяют их.
+  return flow + m_rebalance.Solve(network, source, sink);
+}
+
+std::string DecomposedMaxFlow::GetName() const
+{
+  return "decomposed";
+}
+
+std::vector<std::pair<std::string, size_t>> DecomposedMaxFlow::GetCounters() const
+{
+  if (m_usedFallback)
+  {
+    auto counters = m_rebalance.GetCounters();
+    counters.push_back({"fallback", 1});
+    return counters;
+  }
+  return {
+      {"parts", m_parts.size()},
+      {"threads", m_threads},
+      {"part_flow", m_partFlow},
+      {"rebalance_rounds", m_sharedLeft || m_hadFlow ? m_rebalance.GetRounds() : 0},
+      {"rebalance_paths", m_sharedLeft || m_hadFlow ? m_rebalance.GetAugmentingPaths() : 0}};
+}
+
+bool DecomposedMaxFlow::ReadBipartiteLayer(FlowNetwork const & network, size_t source, size_t sink)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  m_sourceArc.assign(nodeCount, NoIndex);
+  m_sinkArc.assign(nodeCount, NoIndex);
+  m_leftNodes.clear();
+  m_rightNodes.clear();
+
+  for (size_t a = network.ArcsBegin(source); a < network.ArcsEnd(source); ++a)
+  {
+    size_t const node = static_cast<size_t>(network.GetArc(a).to);
+    if (node == sink || m_sourceArc[node] != NoIndex)
+      return false;
+    m_hadFlow |= network.GetArc(static_cast<size_t>(network.GetArc(a).rev)).cap > 0;
+    m_sourceArc[node] = a;
+    m_leftNodes.push_back(node);
+  }
+
+  // Дуги стока в CSR обратные, прямая дуга вершины в сток находится по rev.
+  for (size_t a = network.ArcsBegin(sink); a < network.ArcsEnd(sink); ++a)
+  {
+    size_t const node = static_cast<size_t>(network.GetArc(a).to);
+    if (node == source || m_sourceArc[node] != NoIndex || m_sinkArc[node] != NoIndex)
+      return false;
+    m_sinkArc[node] = static_cast<size_t>(network.GetArc(a).rev);
+    m_rightNodes.push_back(node);
+  }
+
+  // Поток в сети уже может быть, поэтому проверяется только форма: левая доля связана лишь с правой.
+  for (size_t node : m_leftNodes)
+  {
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      size_t const to = static_cast<size_t>(network.GetArc(a).to);
+      if (to != source && m_sinkArc[to] == NoIndex)
+        return false;
+    }
+  }
+  for (size_t node : m_rightNodes)
+  {
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      size_t const to = static_cast<size_t>(network.GetArc(a).to);
+      if (to != sink && m_sourceArc[to] == NoIndex)
+        return false;
+    }
+  }
+  return true;
+}
+
+void DecomposedMaxFlow::SplitIntoParts(FlowNetwork const & network)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  std::vector<size_t> parent(nodeCount);
+  std::iota(parent.begin(), parent.end(), 0);
+  for (size_t node : m_leftNodes)
+  {
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      size_t const to = static_cast<size_t>(network.GetArc(a).to);
+      if (m_sinkArc[to] != NoIndex)
+        parent[FindRoot(parent, to)] = FindRoot(parent, node);
+    }
+  }
+
+  // Часть — правые вершины одной компоненты связности с одинаковой меткой.
+  m_rightPart.assign(nodeCount, NoIndex);
+  m_rightLocal.assign(nodeCount, NoIndex);
+  std::map<std::pair<size_t, size_t>, size_t> partIndex;
+  for (size_t node : m_rightNodes)
+  {
+    size_t const label = node < m_nodeParts.size() ? m_nodeParts[node] : 0;
+    auto const [it, added] = partIndex.emplace(std::make_pair(FindRoot(parent, node), label), m_parts.size());
+    if (added)
+      m_parts.emplace_back();
+
+    Part & part = m_parts[it->second];
+    m_rightPart[node] = it->second;
+    m_rightLocal[node] = part.rightNodes.size();
+    part.rightNodes.push_back(node);
+  }
+}
+
+void DecomposedMaxFlow::DivideLeftCapacities(FlowNetwork const & network, size_t source)
+{
+  // Обратные дуги правой вершины, кроме дуги в сток, — её рёбра из левой доли.
+  for (Part & part : m_parts)
+  {
+    size_t edgeCount = 0;
+    for (size_t node : part.rightNodes)
+      edgeCount += network.ArcsEnd(node) - network.ArcsBegin(node) - 1;
+    part.edges.reserve(edgeCount);
+  }
+
+  // Доля лимита сотрудника в части пропорциональна числу его свободных дуг в неё.
+  m_sharedLeft = false;
+  std::vector<size_t> degree(m_parts.size(), 0);
+  std::vector<size_t> touched;
+  std::vector<std::pair<size_t, size_t>> nodeEdges;
+  for (size_t node : m_leftNodes)
+  {
+    touched.clear();
+    nodeEdges.clear();
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      if (static_cast<size_t>(arc.to) == source || arc.cap <= 0)
+        continue;
+      size_t const p = m_rightPart[arc.to];
+      if (degree[p]++ == 0)
+        touched.push_back(p);
+      nodeEdges.push_back({p, a});
+    }
+    m_sharedLeft |= touched.size() > 1;
+
+    int const cap = network.GetArc(m_sourceArc[node]).cap;
+    int given = 0;
+    for (size_t p : touched)
+    {
+      int const share = static_cast<int>(static_cast<long long>(cap) * degree[p] / nodeEdges.size());
+      degree[p] = m_parts[p].leftNodes.size();
+      m_parts[p].leftNodes.push_back(node);
+      m_parts[p].leftCaps.push_back(share);
+      given += share;
+    }
+    // Остаток от деления получают части по порядку, его меньше, чем частей.
+    for (size_t k = 0; given < cap && !touched.empty(); k = (k + 1) % touched.size(), ++given)
+      ++m_parts[touched[k]].leftCaps.back();
+
+    // После раздела лимитов degree хранит индекс сотрудника в каждой из его частей.
+    for (auto const & [p, a] : nodeEdges)
+      m_parts[p].edges.push_back({degree[p], a});
+    for (size_t p : touched)
+      degree[p] = 0;
+  }
+}
+
+void DecomposedMaxFlow::SolvePart(FlowNetwork const & network, Part & part) const
+{
+  // Потребность без кандидатов ничего не получает, сеть для неё не строится.
+  part.arcs.clear();
+  part.flow = 0;
+  if (part.edges.empty())
+    return;
+
+  size_t const leftCount = part.leftNodes.size();
+  size_t const rightCount = part.rightNodes.size();
+  size_t const source = leftCount + rightCount;
+  size_t const sink = source + 1;
+
+  part.network.Reset(sink + 1);
+  part.network.ReserveEdges(leftCount + part.edges.size() + rightCount);
+  part.arcs.reserve(leftCount + part.edges.size() + rightCount);
+
+  for (size_t left = 0; left < leftCount; ++left)
+  {
+    part.network.AddEdge(source, left, part.leftCaps[left]);
+    part.arcs.push_back(m_sourceArc[part.leftNodes[left]]);
+  }
+  for (auto const & [left, arcIndex] : part.edges)
+  {
+    FlowNetwork::Arc const & arc = network.GetArc(arcIndex);
+    part.network.AddEdge(left, leftCount + m_rightLocal[arc.to], arc.cap);
+    part.arcs.push_back(arcIndex);
+  }
+  for (size_t right = 0; right < rightCount; ++right)
+  {
+    size_t const sinkArc = m_sinkArc[part.rightNodes[right]];
+    part.network.AddEdge(leftCount + right, sink, network.GetArc(sinkArc).cap);
+    part.arcs.push_back(sinkArc);
+  }
+  part.network.Build();
+
+  DinicMaxFlow solver;
+  part.flow = solver.Solve(part.network, source, sink);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "solver/dinic_max_flow.hpp"
+#include "solver/schedule_solver.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*!
+ * Splits the bipartite layer of the schedule network into parts and solves them concurrently.
+ * Right vertices (shift demands) are grouped by connected component and, if given, by their part
+ * label (for example, the day of the shift). Parts of one component share left vertices
+ * (employees), so the residual source capacity of every employee is divided between its parts
+ * in proportion to its edges there. Flows of the parts are put into the network, and a final
+ * Dinic run over the whole network rebalances them, so the result is the maximal flow.
+ * Parts that share no left vertices are independent and need no rebalancing, unless the network
+ * already carries flow: part networks hold only residual capacities and cannot reroute it.
+ * Parts are solved on one thread when the solver itself runs inside RunOnNewThreads.
+ * Networks of another shape are solved with DinicMaxFlow.
+ */
+class DecomposedMaxFlow : public ScheduleSolver
+{
+public:
+  //! Labels of right vertices by node index; empty means that only connected components are split.
+  explicit DecomposedMaxFlow(std::vector<size_t> nodeParts = {});
+
+  int Solve(FlowNetwork & network, size_t source, size_t sink) override;
+  std::string GetName() const override;
+  std::vector<std::pair<std::string, size_t>> GetCounters() const override;
+
+private:
+  struct Part
+  {
+    std::vector<size_t> rightNodes;
+    //! Left vertices with edges to the part and the source capacity given to each of them.
+    std::vector<size_t> leftNodes;
+    std::vector<int> leftCaps;
+    //! Edges from left to right vertices: index in leftNodes and arc of the whole network.
+    std::vector<std::pair<size_t, size_t>> edges;
+    //! Arc of the whole network for every edge of the part network.
+    std::vector<size_t> arcs;
+    FlowNetwork network;
+    int flow = 0;
+  };
+
+  bool ReadBipartiteLayer(FlowNetwork const & network, size_t source, size_t sink);
+  void SplitIntoParts(FlowNetwork const & network);
+  //! Divides residual source capacity of every left vertex between its parts and collects edges of the parts.
+  void DivideLeftCapacities(FlowNetwork const & network, size_t source);
+  void SolvePart(FlowNetwork const & network, Part & part) const;
+
+  std::vector<size_t> m_nodeParts;
+
+  std::vector<size_t> m_sourceArc;
+  std::vector<size_t> m_sinkArc;
+  std::vector<size_t> m_leftNodes;
+  std::vector<size_t> m_rightNodes;
+  //! Part of every right vertex and its index in the part.
+  std::vector<size_t> m_rightPart;
+  std::vector<size_t> m_rightLocal;
+  std::vector<Part> m_parts;
+  DinicMaxFlow m_rebalance;
+
+  size_t m_threads = 0;
+  size_t m_partFlow = 0;
+  //! Some left vertex has edges to several parts, so the flows of the parts have to be rebalanced.
+  bool m_sharedLeft = false;
+  //! Flow was in the network before the run; it is rerouted only by the final run over the whole network.
+  bool m_hadFlow = false;
+  bool m_usedFallback = false;
+};
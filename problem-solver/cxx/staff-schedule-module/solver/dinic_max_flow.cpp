@@ -0,0 +1,125 @@
+#include "dinic_max_flow.hpp"
+
+#include <algorithm>
+#include <limits>
+
+int DinicMaxFlow::Solve(FlowNetwork & network, size_t source, size_t sink)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  m_level.assign(nodeCount, -1);
+  m_currentArc.assign(nodeCount, 0);
+  m_queue.reserve(nodeCount);
+  m_rounds = 0;
+  m_augmentingPaths = 0;
+
+  int flow = 0;
+  while (BuildLevels(network, source, sink))
+  {
+    ++m_rounds;
+    for (size_t node = 0; node < nodeCount; ++node)
+      m_currentArc[node] = network.ArcsBegin(node);
+
+    flow += FindBlockingFlow(network, source, sink);
+  }
+  return flow;
+}
+
+std::string DinicMaxFlow::GetName() const
+{
+  return "dinic";
+}
+
+std::vector<std::pair<std::string, size_t>> DinicMaxFlow::GetCounters() const
+{
+  return {{"bfs_rounds", m_rounds}, {"augmenting_paths", m_augmentingPaths}};
+}
+
+size_t DinicMaxFlow::GetRounds() const
+{
+  return m_rounds;
+}
+
+size_t DinicMaxFlow::GetAugmentingPaths() const
+{
+  return m_augmentingPaths;
+}
+
+bool DinicMaxFlow::BuildLevels(FlowNetwork const & network, size_t source, size_t sink)
+{
+  std::fill(m_level.begin(), m_level.end(), -1);
+  m_queue.clear();
+  m_queue.push_back(source);
+  m_level[source] = 0;
+
+  for (size_t qi = 0; qi < m_queue.size(); ++qi)
+  {
+    size_t const node = m_queue[qi];
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      if (arc.cap > 0 && m_level[arc.to] == -1)
+      {
+        m_level[arc.to] = m_level[node] + 1;
+        m_queue.push_back(static_cast<size_t>(arc.to));
+      }
+    }
+  }
+  return m_level[sink] != -1;
+}
+
+int DinicMaxFlow::FindBlockingFlow(FlowNetwork & network, size_t source, size_t sink)
+{
+  int flow = 0;
+  m_path.clear();
+  size_t node = source;
+
+  while (true)
+  {
+    if (node == sink)
+    {
+      // Проталкиваем по пути сразу всю пропускную способность его узкого места.
+      int pushed = std::numeric_limits<int>::max();
+      for (size_t a : m_path)
+        pushed = std::min(pushed, network.GetArc(a).cap);
+      for (size_t a : m_path)
+        network.Push(a, pushed);
+
+      flow += pushed;
+      ++m_augmentingPaths;
+
+      // Продолжаем поиск от начала первой насыщенной дуги, префикс пути остаётся.
+      size_t keep = 0;
+      while (keep < m_path.size() && network.GetArc(m_path[keep]).cap > 0)
+        ++keep;
+      m_path.resize(keep);
+      node = m_path.empty() ? source : static_cast<size_t>(network.GetArc(m_path.back()).to);
+      continue;
+    }
+
+    size_t & a = m_currentArc[node];
+    size_t const end = network.ArcsEnd(node);
+    while (a < end)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      if (arc.cap > 0 && m_level[arc.to] == m_level[node] + 1)
+        break;
+      ++a;
+    }
+
+    if (a < end)
+    {
+      m_path.push_back(a);
+      node = static_cast<size_t>(network.GetArc(a).to);
+      continue;
+    }
+
+    // Тупик: вершина больше не участвует в этой фазе, возвращаемся на шаг назад.
+    if (node == source)
+      break;
+    m_level[node] = -1;
+    m_path.pop_back();
+    node = m_path.empty() ? source : static_cast<size_t>(network.GetArc(m_path.back()).to);
+  }
+
+  return flow;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "solver/schedule_solver.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * Dinic maximal flow algorithm over FlowNetwork. Blocking flow is searched with an explicit
+ * arc stack instead of recursion: the path is advanced by admissible arcs, its bottleneck is
+ * pushed at once, and the search continues from the tail of the first saturated arc.
+ * Buffers are kept between runs, so one instance can solve many networks.
+ */
+class DinicMaxFlow : public ScheduleSolver
+{
+public:
+  int Solve(FlowNetwork & network, size_t source, size_t sink) override;
+  std::string GetName() const override;
+  std::vector<std::pair<std::string, size_t>> GetCounters() const override;
+
+  //! Number of BFS rounds (blocking flow phases) of the last run.
+  size_t GetRounds() const;
+
+  //! Number of augmenting paths of the last run.
+  size_t GetAugmentingPaths() const;
+
+private:
+  bool BuildLevels(FlowNetwork const & network, size_t source, size_t sink);
+  int FindBlockingFlow(FlowNetwork & network, size_t source, size_t sink);
+
+  std::vector<int> m_level;
+  std::vector<size_t> m_currentArc;
+  std::vector<size_t> m_queue;
+  std::vector<size_t> m_path;
+
+  size_t m_rounds = 0;
+  size_t m_augmentingPaths = 0;
+};
@@ -0,0 +1,77 @@
+#include "flow_network.hpp"
+
+FlowNetwork::FlowNetwork(size_t nodeCount)
+{
+  Reset(nodeCount);
+}
+
+void FlowNetwork::Reset(size_t nodeCount)
+{
+  m_nodeCount = nodeCount;
+  m_pendingEdges.clear();
+  m_offsets.assign(nodeCount + 1, 0);
+  m_arcs.clear();
+  m_edgeArcs.clear();
+}
+
+void FlowNetwork::ReserveEdges(size_t edgeCount)
+{
+  m_pendingEdges.reserve(edgeCount);
+}
+
+size_t FlowNetwork::AddEdge(size_t from, size_t to, int capacity)
+{
+  m_pendingEdges.push_back({from, to, capacity});
+  return m_pendingEdges.size() - 1;
+}
+
+void FlowNetwork::Build()
+{
+  // Первый проход считает степени вершин, второй раскладывает дуги по местам.
+  m_offsets.assign(m_nodeCount + 1, 0);
+  for (auto const & edge : m_pendingEdges)
+  {
+    ++m_offsets[edge.from + 1];
+    ++m_offsets[edge.to + 1];
+  }
+  for (size_t node = 0; node < m_nodeCount; ++node)
+    m_offsets[node + 1] += m_offsets[node];
+
+  std::vector<size_t> position(m_offsets.begin(), m_offsets.end() - 1);
+  m_arcs.resize(m_pendingEdges.size() * 2);
+  m_edgeArcs.resize(m_pendingEdges.size());
+
+  for (size_t edgeIndex = 0; edgeIndex < m_pendingEdges.size(); ++edgeIndex)
+  {
+    PendingEdge const & edge = m_pendingEdges[edgeIndex];
+    size_t const forward = position[edge.from]++;
+    size_t const backward = position[edge.to]++;
+
+    m_arcs[forward] = {static_cast<int>(edge.to), static_cast<int>(backward), edge.cap};
+    m_arcs[backward] = {static_cast<int>(edge.from), static_cast<int>(forward), 0};
+    m_edgeArcs[edgeIndex] = forward;
+  }
+
+  m_pendingEdges.clear();
+  m_pendingEdges.shrink_to_fit();
+}
+
+size_t FlowNetwork::GetNodeCount() const
+{
+  return m_nodeCount;
+}
+
+size_t FlowNetwork::GetEdgeCount() const
+{
+  return m_edgeArcs.size();
+}
+
+size_t FlowNetwork::GetEdgeArc(size_t edgeIndex) const
+{
+  return m_edgeArcs[edgeIndex];
+}
+
+int FlowNetwork::GetEdgeFlow(size_t edgeIndex) const
+{
+  return m_arcs[m_arcs[m_edgeArcs[edgeIndex]].rev].cap;
+}
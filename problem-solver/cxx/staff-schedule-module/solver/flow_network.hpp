@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * Flow network stored in compressed sparse row form. Edges are collected with AddEdge first,
+ * then Build places forward and residual arcs of every node into one contiguous array.
+ * Nodes are dense indices in [0, GetNodeCount()).
+ */
+class FlowNetwork
+{
+public:
+  struct Arc
+  {
+    int to;
+    int rev;
+    int cap;
+  };
+
+  explicit FlowNetwork(size_t nodeCount = 0);
+
+  //! Drops all edges and sets new number of nodes.
+  void Reset(size_t nodeCount);
+
+  //! Reserves memory for the given number of edges, if it is known before building.
+  void ReserveEdges(size_t edgeCount);
+
+  //! Adds edge and returns its index. Must be called before Build.
+  size_t AddEdge(size_t from, size_t to, int capacity);
+
+  //! Places collected edges into the arc array; the network can be searched after this call.
+  void Build();
+
+  size_t GetNodeCount() const;
+  size_t GetEdgeCount() const;
+
+  size_t ArcsBegin(size_t node) const
+  {
+    return m_offsets[node];
+  }
+
+  size_t ArcsEnd(size_t node) const
+  {
+    return m_offsets[node + 1];
+  }
+
+  Arc & GetArc(size_t arcIndex)
+  {
+    return m_arcs[arcIndex];
+  }
+
+  Arc const & GetArc(size_t arcIndex) const
+  {
+    return m_arcs[arcIndex];
+  }
+
+  //! Pushes flow through the arc and its residual pair.
+  void Push(size_t arcIndex, int flow)
+  {
+    Arc & arc = m_arcs[arcIndex];
+    arc.cap -= flow;
+    m_arcs[arc.rev].cap += flow;
+  }
+
+  //! Returns index of the forward arc of the edge.
+  size_t GetEdgeArc(size_t edgeIndex) const;
+
+  //! Returns flow that goes through the edge.
+  int GetEdgeFlow(size_t edgeIndex) const;
+
+private:
+  struct PendingEdge
+  {
+    size_t from;
+    size_t to;
+    int cap;
+  };
+
+  size_t m_nodeCount = 0;
+  std::vector<PendingEdge> m_pendingEdges;
+  std::vector<size_t> m_offsets;
+  std::vector<Arc> m_arcs;
+  std::vector<size_t> m_edgeArcs;
+};
@@ -0,0 +1,237 @@
+#include "hopcroft_karp_max_flow.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+size_t const NoIndex = std::numeric_limits<size_t>::max();
+}  // namespace
+
+int HopcroftKarpMaxFlow::Solve(FlowNetwork & network, size_t source, size_t sink)
+{
+  m_phases = 0;
+  m_augmentingPaths = 0;
+  m_usedFallback = !ReadBipartiteLayer(network, source, sink);
+  if (m_usedFallback)
+    return m_fallback.Solve(network, source, sink);
+
+  while (BuildLayers(network))
+  {
+    ++m_phases;
+    for (size_t left = 0; left < m_leftNode.size(); ++left)
+      m_nextArc[left] = network.ArcsBegin(m_leftNode[left]);
+
+    for (size_t left = 0; left < m_leftNode.size(); ++left)
+    {
+      if (m_distance[left] != 0)
+        continue;
+      while (m_leftUsed[left] < m_leftCap[left] && Augment(network, left))
+        ++m_augmentingPaths;
+    }
+  }
+
+  // Единичные дуги уже содержат паросочетание, осталось провести поток через исток и сток.
+  int flow = 0;
+  for (size_t left = 0; left < m_leftNode.size(); ++left)
+  {
+    network.Push(m_leftArc[left], m_leftUsed[left]);
+    flow += m_leftUsed[left];
+  }
+  for (size_t right = 0; right < m_rightArc.size(); ++right)
+    network.Push(m_rightArc[right], m_rightUsed[right]);
+  return flow;
+}
+
+std::string HopcroftKarpMaxFlow::GetName() const
+{
+  return "hopcroft_karp";
+}
+
+std::vector<std::pair<std::string, size_t>> HopcroftKarpMaxFlow::GetCounters() const
+{
+  if (m_usedFallback)
+  {
+    auto counters = m_fallback.GetCounters();
+    counters.push_back({"fallback", 1});
+    return counters;
+  }
+  return {{"bfs_rounds", m_phases}, {"augmenting_paths", m_augmentingPaths}};
+}
+
+bool HopcroftKarpMaxFlow::ReadBipartiteLayer(FlowNetwork const & network, size_t source, size_t sink)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  m_leftIndex.assign(nodeCount, NoIndex);
+  m_rightIndex.assign(nodeCount, NoIndex);
+  m_leftNode.clear();
+  m_leftArc.clear();
+  m_leftCap.clear();
+  m_rightNode.clear();
+  m_rightArc.clear();
+  m_rightCap.clear();
+
+  for (size_t a = network.ArcsBegin(source); a < network.ArcsEnd(source); ++a)
+  {
+    FlowNetwork::Arc const & arc = network.GetArc(a);
+    if (arc.cap <= 0)
+      continue;
+    size_t const node = static_cast<size_t>(arc.to);
+    if (node == sink || m_leftIndex[node] != NoIndex)
+      return false;
+    m_leftIndex[node] = m_leftNode.size();
+    m_leftNode.push_back(node);
+    m_leftArc.push_back(a);
+    m_leftCap.push_back(arc.cap);
+  }
+
+  // Дуги стока в CSR обратные, прямая дуга вершины в сток находится по rev.
+  for (size_t a = network.ArcsBegin(sink); a < network.ArcsEnd(sink); ++a)
+  {
+    size_t const forward = static_cast<size_t>(network.GetArc(a).rev);
+    FlowNetwork::Arc const & arc = network.GetArc(forward);
+    size_t const node = static_cast<size_t>(network.GetArc(a).to);
+    if (arc.cap <= 0 || node == source)
+      continue;
+    if (m_leftIndex[node] != NoIndex || m_rightIndex[node] != NoIndex)
+      return false;
+    m_rightIndex[node] = m_rightNode.size();
+    m_rightNode.push_back(node);
+    m_rightArc.push_back(forward);
+    m_rightCap.push_back(arc.cap);
+  }
+
+  // Паросочетание ищется прямо на дугах сети, поэтому проверяем, что она двудольная и ещё без потока:
+  // из левой доли ведут только единичные дуги в правую, из правой остаточная ёмкость есть только к стоку.
+  for (size_t left = 0; left < m_leftNode.size(); ++left)
+  {
+    size_t const node = m_leftNode[left];
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      if (static_cast<size_t>(arc.to) == source)
+      {
+        if (arc.cap != 0)
+          return false;
+        continue;
+      }
+      if (m_rightIndex[arc.to] == NoIndex || arc.cap != 1)
+        return false;
+    }
+  }
+  for (size_t right = 0; right < m_rightNode.size(); ++right)
+  {
+    size_t const node = m_rightNode[right];
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      if (arc.cap > 0 && static_cast<size_t>(arc.to) != sink)
+        return false;
+    }
+  }
+
+  m_leftUsed.assign(m_leftNode.size(), 0);
+  m_rightUsed.assign(m_rightNode.size(), 0);
+  m_rightMatched.assign(m_rightNode.size(), {});
+  m_distance.assign(m_leftNode.size(), NoIndex);
+  m_rightVisited.assign(m_rightNode.size(), 0);
+  m_nextArc.assign(m_leftNode.size(), 0);
+  m_queue.reserve(m_leftNode.size());
+  return true;
+}
+
+bool HopcroftKarpMaxFlow::BuildLayers(FlowNetwork const & network)
+{
+  std::fill(m_distance.begin(), m_distance.end(), NoIndex);
+  std::fill(m_rightVisited.begin(), m_rightVisited.end(), 0);
+  m_queue.clear();
+  for (size_t left = 0; left < m_leftNode.size(); ++left)
+  {
+    if (m_leftUsed[left] < m_leftCap[left])
+    {
+      m_distance[left] = 0;
+      m_queue.push_back(left);
+    }
+  }
+
+  bool found = false;
+  for (size_t qi = 0; qi < m_queue.size(); ++qi)
+  {
+    size_t const left = m_queue[qi];
+    size_t const node = m_leftNode[left];
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      FlowNetwork::Arc const & arc = network.GetArc(a);
+      size_t const right = m_rightIndex[arc.to];
+      if (right == NoIndex || arc.cap == 0)
+        continue;
+      if (m_rightUsed[right] < m_rightCap[right])
+      {
+        found = true;
+        continue;
+      }
+      if (m_rightVisited[right])
+        continue;
+      m_rightVisited[right] = 1;
+
+      // Из заполненной правой вершины идём по её назначениям к другим сотрудникам.
+      for (size_t matched : m_rightMatched[right])
+      {
+        size_t const next = MatchedLeft(network, matched);
+        if (m_distance[next] == NoIndex)
+        {
+          m_distance[next] = m_distance[left] + 1;
+          m_queue.push_back(next);
+        }
+      }
+    }
+  }
+  return found;
+}
+
+bool HopcroftKarpMaxFlow::Augment(FlowNetwork & network, size_t left)
+{
+  // Глубина рекурсии ограничена числом слоёв BFS.
+  size_t const end = network.ArcsEnd(m_leftNode[left]);
+  for (size_t & a = m_nextArc[left]; a < end; ++a)
+  {
+    FlowNetwork::Arc const & arc = network.GetArc(a);
+    size_t const right = m_rightIndex[arc.to];
+    if (right == NoIndex || arc.cap == 0)
+      continue;
+    if (m_rightUsed[right] < m_rightCap[right])
+    {
+      network.Push(a, 1);
+      m_leftUsed[left] += 1;
+      m_rightUsed[right] += 1;
+      m_rightMatched[right].push_back(a);
+      return true;
+    }
+
+    std::vector<size_t> & matchedArcs = m_rightMatched[right];
+    for (size_t i = 0; i < matchedArcs.size(); ++i)
+    {
+      size_t const matched = matchedArcs[i];
+      size_t const next = MatchedLeft(network, matched);
+      if (m_distance[next] != m_distance[left] + 1 || !Augment(network, next))
+        continue;
+
+      // Сотрудник next получил другое назначение, его место в right занимает left.
+      network.Push(static_cast<size_t>(network.GetArc(matched).rev), 1);
+      m_leftUsed[next] -= 1;
+      network.Push(a, 1);
+      m_leftUsed[left] += 1;
+      matchedArcs[i] = a;
+      return true;
+    }
+  }
+
+  m_distance[left] = NoIndex;
+  return false;
+}
+
+size_t HopcroftKarpMaxFlow::MatchedLeft(FlowNetwork const & network, size_t matchedArc) const
+{
+  FlowNetwork::Arc const & reverse = network.GetArc(static_cast<size_t>(network.GetArc(matchedArc).rev));
+  return m_leftIndex[reverse.to];
+}
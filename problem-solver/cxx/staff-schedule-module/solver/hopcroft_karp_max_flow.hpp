@@ -0,0 +1,54 @@
+#pragma once
+
+#include "solver/dinic_max_flow.hpp"
+#include "solver/schedule_solver.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * Hopcroft-Karp for the bipartite layer of the schedule network: source -> left (capacity),
+ * left -> right (unit edges), right -> sink (capacity). Left vertices are employees, right
+ * vertices are shift demands. The matching is kept directly in the unit arcs of the network,
+ * flow through source and sink arcs is added at the end.
+ * Networks of another shape, or with flow already in them, are solved with DinicMaxFlow.
+ */
+class HopcroftKarpMaxFlow : public ScheduleSolver
+{
+public:
+  int Solve(FlowNetwork & network, size_t source, size_t sink) override;
+  std::string GetName() const override;
+  std::vector<std::pair<std::string, size_t>> GetCounters() const override;
+
+private:
+  bool ReadBipartiteLayer(FlowNetwork const & network, size_t source, size_t sink);
+  bool BuildLayers(FlowNetwork const & network);
+  bool Augment(FlowNetwork & network, size_t left);
+  size_t MatchedLeft(FlowNetwork const & network, size_t matchedArc) const;
+
+  std::vector<size_t> m_leftNode;
+  std::vector<size_t> m_leftArc;
+  std::vector<int> m_leftCap;
+  std::vector<int> m_leftUsed;
+
+  std::vector<size_t> m_rightNode;
+  std::vector<size_t> m_rightArc;
+  std::vector<int> m_rightCap;
+  std::vector<int> m_rightUsed;
+  //! Matched left -> right arcs of every right vertex.
+  std::vector<std::vector<size_t>> m_rightMatched;
+
+  //! Local index of a network node in its part, or NoIndex.
+  std::vector<size_t> m_leftIndex;
+  std::vector<size_t> m_rightIndex;
+
+  std::vector<size_t> m_distance;
+  std::vector<char> m_rightVisited;
+  std::vector<size_t> m_nextArc;
+  std::vector<size_t> m_queue;
+
+  DinicMaxFlow m_fallback;
+  bool m_usedFallback = false;
+  size_t m_phases = 0;
+  size_t m_augmentingPaths = 0;
+};
@@ -0,0 +1,198 @@
+#include "min_cost_max_flow.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+int const Unreached = std::numeric_limits<int>::max();
+
+// Поток по дуге хранится в ёмкости обратной дуги, следующая единица стоит 2 * поток + 1.
+int GetMarginalCost(FlowNetwork const & network, FlowNetwork::Arc const & arc)
+{
+  return 2 * network.GetArc(static_cast<size_t>(arc.rev)).cap + 1;
+}
+}  // namespace
+
+int MinCostMaxFlow::Solve(FlowNetwork & network, size_t source, size_t sink)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  m_distance.assign(nodeCount, Unreached);
+  m_level.assign(nodeCount, -1);
+  m_currentArc.assign(nodeCount, 0);
+  m_queue.reserve(nodeCount);
+  m_phases = 0;
+  m_rounds = 0;
+  m_augmentingPaths = 0;
+
+  int flow = 0;
+  while (int const length = FindDistances(network, source, sink))
+  {
+    ++m_phases;
+    while (BuildLevels(network, source, sink, length))
+    {
+      ++m_rounds;
+      for (size_t node = 0; node < nodeCount; ++node)
+        m_currentArc[node] = network.ArcsBegin(node);
+
+      flow += FindBlockingFlow(network, source, sink, length);
+    }
+  }
+
+  m_cost = 0;
+  for (size_t a = network.ArcsBegin(source); a < network.ArcsEnd(source); ++a)
+  {
+    size_t const load = static_cast<size_t>(network.GetArc(static_cast<size_t>(network.GetArc(a).rev)).cap);
+    m_cost += load * load;
+  }
+  return flow;
+}
+
+std::string MinCostMaxFlow::GetName() const
+{
+  return "min_cost";
+}
+
+std::vector<std::pair<std::string, size_t>> MinCostMaxFlow::GetCounters() const
+{
+  return {
+      {"phases", m_phases}, {"bfs_rounds", m_rounds}, {"augmenting_paths", m_augmentingPaths}, {"cost", m_cost}};
+}
+
+size_t MinCostMaxFlow::GetCost() const
+{
+  return m_cost;
+}
+
+int MinCostMaxFlow::FindDistances(FlowNetwork const & network, size_t source, size_t sink)
+{
+  m_sourceArcs.clear();
+  for (size_t a = network.ArcsBegin(source); a < network.ArcsEnd(source); ++a)
+  {
+    FlowNetwork::Arc const & arc = network.GetArc(a);
+    if (arc.cap > 0)
+      m_sourceArcs.push_back({GetMarginalCost(network, arc), a});
+  }
+  std::sort(m_sourceArcs.begin(), m_sourceArcs.end());
+
+  // Внутренние дуги бесплатны: вершина получает стоимость самого дешёвого сотрудника, из которого достижима.
+  std::fill(m_distance.begin(), m_distance.end(), Unreached);
+  m_distance[source] = 0;
+  for (size_t first = 0; first < m_sourceArcs.size();)
+  {
+    int const cost = m_sourceArcs[first].first;
+    m_queue.clear();
+    for (; first < m_sourceArcs.size() && m_sourceArcs[first].first == cost; ++first)
+    {
+      size_t const node = static_cast<size_t>(network.GetArc(m_sourceArcs[first].second).to);
+      if (m_distance[node] == Unreached)
+      {
+        m_distance[node] = cost;
+        m_queue.push_back(node);
+      }
+    }
+
+    for (size_t qi = 0; qi < m_queue.size(); ++qi)
+    {
+      size_t const node = m_queue[qi];
+      for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+      {
+        FlowNetwork::Arc const & arc = network.GetArc(a);
+        if (arc.cap > 0 && m_distance[arc.to] == Unreached)
+        {
+          m_distance[arc.to] = cost;
+          m_queue.push_back(static_cast<size_t>(arc.to));
+        }
+      }
+    }
+
+    if (m_distance[sink] != Unreached)
+      return m_distance[sink];
+  }
+  return 0;
+}
+
+bool MinCostMaxFlow::IsAdmissible(
+    FlowNetwork const & network,
+    size_t source,
+    size_t node,
+    size_t arcIndex,
+    int length) const
+{
+  FlowNetwork::Arc const & arc = network.GetArc(arcIndex);
+  if (arc.cap <= 0 || m_distance[arc.to] != length)
+    return false;
+  // Из истока в фазе допустима только дуга, следующая единица которой стоит ровно length.
+  return node != source || GetMarginalCost(network, arc) == length;
+}
+
+bool MinCostMaxFlow::BuildLevels(FlowNetwork const & network, size_t source, size_t sink, int length)
+{
+  std::fill(m_level.begin(), m_level.end(), -1);
+  m_queue.clear();
+  m_queue.push_back(source);
+  m_level[source] = 0;
+
+  for (size_t qi = 0; qi < m_queue.size(); ++qi)
+  {
+    size_t const node = m_queue[qi];
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      size_t const to = static_cast<size_t>(network.GetArc(a).to);
+      if (m_level[to] == -1 && IsAdmissible(network, source, node, a, length))
+      {
+        m_level[to] = m_level[node] + 1;
+        m_queue.push_back(to);
+      }
+    }
+  }
+  return m_level[sink] != -1;
+}
+
+int MinCostMaxFlow::FindBlockingFlow(FlowNetwork & network, size_t source, size_t sink, int length)
+{
+  int flow = 0;
+  m_path.clear();
+  size_t node = source;
+
+  while (true)
+  {
+    if (node == sink)
+    {
+      // Дуга из истока несёт в фазе одну единицу: следующая уже стоит дороже, поэтому путь начинается заново.
+      for (size_t a : m_path)
+        network.Push(a, 1);
+
+      ++flow;
+      ++m_augmentingPaths;
+      m_path.clear();
+      node = source;
+      continue;
+    }
+
+    size_t & a = m_currentArc[node];
+    size_t const end = network.ArcsEnd(node);
+    while (a < end)
+    {
+      if (m_level[network.GetArc(a).to] == m_level[node] + 1 && IsAdmissible(network, source, node, a, length))
+        break;
+      ++a;
+    }
+
+    if (a < end)
+    {
+      m_path.push_back(a);
+      node = static_cast<size_t>(network.GetArc(a).to);
+      continue;
+    }
+
+    // Тупик: вершина больше не участвует в этом раунде, возвращаемся на шаг назад.
+    if (node == source)
+      break;
+    m_level[node] = -1;
+    m_path.pop_back();
+    node = m_path.empty() ? source : static_cast<size_t>(network.GetArc(m_path.back()).to);
+  }
+
+  return flow;
+}
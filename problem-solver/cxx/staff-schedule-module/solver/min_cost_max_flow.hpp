@@ -0,0 +1,50 @@
+#pragma once
+
+#include "solver/schedule_solver.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * Maximal flow of minimal convex cost: the k-th unit of flow through an arc from the source costs 2k - 1,
+ * so the cost of the flow is the sum of squared loads of source successors (employees), and among maximal
+ * flows the one with the most even load is found. Other arcs cost nothing.
+ *
+ * Successive shortest paths grouped by length (primal-dual). With free inner arcs the distance of a vertex
+ * is the cheapest marginal cost of an employee that reaches it, so distances are found by a bucketed BFS
+ * without Dijkstra. A phase of length D then runs Dinic over vertices at distance D, giving one unit to
+ * every employee whose marginal cost is D. Lengths only grow and are odd numbers below 2 * maxShifts, so
+ * the number of phases is at most the largest load.
+ *
+ * Flow already in the network is kept; the result is optimal when the search starts from zero flow.
+ */
+class MinCostMaxFlow : public ScheduleSolver
+{
+public:
+  int Solve(FlowNetwork & network, size_t source, size_t sink) override;
+  std::string GetName() const override;
+  std::vector<std::pair<std::string, size_t>> GetCounters() const override;
+
+  //! Sum of squared loads of source arcs after the last run.
+  size_t GetCost() const;
+
+private:
+  //! Finds distances from the source and returns the distance of the sink, or 0 if it is not reachable.
+  int FindDistances(FlowNetwork const & network, size_t source, size_t sink);
+  bool BuildLevels(FlowNetwork const & network, size_t source, size_t sink, int length);
+  int FindBlockingFlow(FlowNetwork & network, size_t source, size_t sink, int length);
+  bool IsAdmissible(FlowNetwork const & network, size_t source, size_t node, size_t arcIndex, int length) const;
+
+  std::vector<int> m_distance;
+  std::vector<int> m_level;
+  std::vector<size_t> m_currentArc;
+  std::vector<size_t> m_queue;
+  std::vector<size_t> m_path;
+  //! Source arcs with residual capacity by marginal cost.
+  std::vector<std::pair<int, size_t>> m_sourceArcs;
+
+  size_t m_phases = 0;
+  size_t m_rounds = 0;
+  size_t m_augmentingPaths = 0;
+  size_t m_cost = 0;
+};
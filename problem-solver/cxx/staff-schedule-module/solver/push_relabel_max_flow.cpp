@@ -0,0 +1,159 @@
+#include "push_relabel_max_flow.hpp"
+
+#include <algorithm>
+
+int PushRelabelMaxFlow::Solve(FlowNetwork & network, size_t source, size_t sink)
+{
+  m_nodeCount = network.GetNodeCount();
+  m_height.assign(m_nodeCount, 0);
+  m_excess.assign(m_nodeCount, 0);
+  m_currentArc.assign(m_nodeCount, 0);
+  m_buckets.assign(2 * m_nodeCount + 1, {});
+  m_queue.reserve(m_nodeCount);
+  m_highest = 0;
+  m_pushes = 0;
+  m_relabels = 0;
+  m_globalRelabels = 0;
+  m_relabelsSinceGlobal = 0;
+
+  // Насыщаем все дуги истока, дальше избыток расходится по сети.
+  for (size_t a = network.ArcsBegin(source); a < network.ArcsEnd(source); ++a)
+  {
+    FlowNetwork::Arc const & arc = network.GetArc(a);
+    if (arc.cap <= 0)
+      continue;
+    int const pushed = arc.cap;
+    m_excess[arc.to] += pushed;
+    m_excess[source] -= pushed;
+    network.Push(a, pushed);
+  }
+
+  GlobalRelabel(network, source, sink);
+
+  while (true)
+  {
+    while (m_highest > 0 && m_buckets[m_highest].empty())
+      --m_highest;
+    if (m_buckets[m_highest].empty())
+      break;
+
+    size_t const node = m_buckets[m_highest].back();
+    m_buckets[m_highest].pop_back();
+    Discharge(network, node, source, sink);
+
+    if (m_relabelsSinceGlobal >= m_nodeCount)
+      GlobalRelabel(network, source, sink);
+  }
+
+  return m_excess[sink];
+}
+
+std::string PushRelabelMaxFlow::GetName() const
+{
+  return "push_relabel";
+}
+
+std::vector<std::pair<std::string, size_t>> PushRelabelMaxFlow::GetCounters() const
+{
+  return {{"pushes", m_pushes}, {"relabels", m_relabels}, {"global_relabels", m_globalRelabels}};
+}
+
+void PushRelabelMaxFlow::GlobalRelabel(FlowNetwork const & network, size_t source, size_t sink)
+{
+  ++m_globalRelabels;
+  m_relabelsSinceGlobal = 0;
+
+  // Высота — расстояние до стока по остаточной сети; вершины, из которых сток недостижим,
+  // получают высоту n плюс расстояние до истока.
+  size_t const unreached = 2 * m_nodeCount;
+  std::fill(m_height.begin(), m_height.end(), unreached);
+  m_height[source] = m_nodeCount;
+
+  for (size_t root : {sink, source})
+  {
+    if (root == sink)
+      m_height[sink] = 0;
+    m_queue.clear();
+    m_queue.push_back(root);
+    for (size_t qi = 0; qi < m_queue.size(); ++qi)
+    {
+      size_t const node = m_queue[qi];
+      for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+      {
+        FlowNetwork::Arc const & arc = network.GetArc(a);
+        size_t const next = static_cast<size_t>(arc.to);
+        if (m_height[next] != unreached || network.GetArc(static_cast<size_t>(arc.rev)).cap <= 0)
+          continue;
+        m_height[next] = m_height[node] + 1;
+        m_queue.push_back(next);
+      }
+    }
+  }
+
+  for (auto & bucket : m_buckets)
+    bucket.clear();
+  m_highest = 0;
+  for (size_t node = 0; node < m_nodeCount; ++node)
+  {
+    m_currentArc[node] = network.ArcsBegin(node);
+    if (node != source && node != sink && m_excess[node] > 0)
+      Activate(node);
+  }
+}
+
+void PushRelabelMaxFlow::Discharge(FlowNetwork & network, size_t node, size_t source, size_t sink)
+{
+  while (m_excess[node] > 0)
+  {
+    if (m_currentArc[node] == network.ArcsEnd(node))
+    {
+      Relabel(network, node);
+      continue;
+    }
+
+    size_t const a = m_currentArc[node];
+    FlowNetwork::Arc const & arc = network.GetArc(a);
+    size_t const next = static_cast<size_t>(arc.to);
+    if (arc.cap <= 0 || m_height[node] != m_height[next] + 1)
+    {
+      ++m_currentArc[node];
+      continue;
+    }
+
+    int const pushed = std::min(m_excess[node], arc.cap);
+    network.Push(a, pushed);
+    m_excess[node] -= pushed;
+    if (m_excess[next] == 0 && next != source && next != sink)
+    {
+      m_excess[next] = pushed;
+      Activate(next);
+    }
+    else
+    {
+      m_excess[next] += pushed;
+    }
+    ++m_pushes;
+  }
+}
+
+void PushRelabelMaxFlow::Relabel(FlowNetwork const & network, size_t node)
+{
+  ++m_relabels;
+  ++m_relabelsSinceGlobal;
+
+  size_t height = 2 * m_nodeCount;
+  for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+  {
+    FlowNetwork::Arc const & arc = network.GetArc(a);
+    if (arc.cap > 0)
+      height = std::min(height, m_height[arc.to] + 1);
+  }
+  m_height[node] = height;
+  m_currentArc[node] = network.ArcsBegin(node);
+}
+
+void PushRelabelMaxFlow::Activate(size_t node)
+{
+  m_buckets[m_height[node]].push_back(node);
+  m_highest = std::max(m_highest, m_height[node]);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "solver/schedule_solver.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * Highest-label push-relabel over FlowNetwork. Active vertices are kept in buckets by height
+ * and the highest one is discharged first. Heights are recomputed by a global relabel (reverse
+ * BFS from the sink, then from the source) at start and after every GetNodeCount() relabels.
+ * Excess that cannot reach the sink returns to the source, so the result is a valid flow.
+ */
+class PushRelabelMaxFlow : public ScheduleSolver
+{
+public:
+  int Solve(FlowNetwork & network, size_t source, size_t sink) override;
+  std::string GetName() const override;
+  std::vector<std::pair<std::string, size_t>> GetCounters() const override;
+
+private:
+  void GlobalRelabel(FlowNetwork const & network, size_t source, size_t sink);
+  void Discharge(FlowNetwork & network, size_t node, size_t source, size_t sink);
+  void Relabel(FlowNetwork const & network, size_t node);
+  void Activate(size_t node);
+
+  std::vector<size_t> m_height;
+  std::vector<int> m_excess;
+  std::vector<size_t> m_currentArc;
+  std::vector<std::vector<size_t>> m_buckets;
+  std::vector<size_t> m_queue;
+  size_t m_highest = 0;
+  size_t m_nodeCount = 0;
+
+  size_t m_pushes = 0;
+  size_t m_relabels = 0;
+  size_t m_globalRelabels = 0;
+  size_t m_relabelsSinceGlobal = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Set on threads that run tasks of RunOnNewThreads.
+inline thread_local bool insideRunOnNewThreads = false;
+
+/*!
+ * Calls task(i) for every i in [0, count) on at most one thread per hardware core, the calling
+ * thread included, and returns the number of threads used. The other threads are started for this
+ * call and joined before it returns, so it suits a few long tasks, not many short calls.
+ * A call from a task of another RunOnNewThreads runs on the calling thread only, so nested loops
+ * do not oversubscribe the cores. The first exception of a task is rethrown after all threads finish.
+ */
+template <typename TTask>
+size_t RunOnNewThreads(size_t count, TTask && task)
+{
+  size_t const threadCount =
+      insideRunOnNewThreads ? std::min<size_t>(count, 1)
+                        : std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+
+  std::atomic<size_t> next{0};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto const run = [&]() {
+    bool const wasInside = insideRunOnNewThreads;
+    insideRunOnNewThreads = true;
+    for (size_t i = next++; i < count; i = next++)
+    {
+      try
+      {
+        task(i);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+    insideRunOnNewThreads = wasInside;
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threadCount; ++t)
+    workers.emplace_back(run);
+  run();
+  for (auto & worker : workers)
+    worker.join();
+
+  if (error)
+    std::rethrow_exception(error);
+  return threadCount;
+}
@@ -0,0 +1,28 @@
+#include "schedule_solver.hpp"
+
+#include "solver/decomposed_max_flow.hpp"
+#include "solver/dinic_max_flow.hpp"
+#include "solver/hopcroft_karp_max_flow.hpp"
+#include "solver/min_cost_max_flow.hpp"
+#include "solver/push_relabel_max_flow.hpp"
+#include "solver/weighted_max_flow.hpp"
+
+std::unique_ptr<ScheduleSolver> CreateScheduleSolver(ScheduleSolverType type)
+{
+  switch (type)
+  {
+  case ScheduleSolverType::HopcroftKarp:
+    return std::make_unique<HopcroftKarpMaxFlow>();
+  case ScheduleSolverType::PushRelabel:
+    return std::make_unique<PushRelabelMaxFlow>();
+  case ScheduleSolverType::Decomposed:
+    return std::make_unique<DecomposedMaxFlow>();
+  case ScheduleSolverType::MinCost:
+    return std::make_unique<MinCostMaxFlow>();
+  case ScheduleSolverType::Preference:
+    return std::make_unique<WeightedMaxFlow>();
+  case ScheduleSolverType::Dinic:
+  default:
+    return std::make_unique<DinicMaxFlow>();
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "solver/flow_network.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class ScheduleSolverType
+{
+  Dinic,
+  HopcroftKarp,
+  PushRelabel,
+  //! Parts of the network solved concurrently, see DecomposedMaxFlow.
+  Decomposed,
+  //! Maximal flow with the most even load of employees, see MinCostMaxFlow.
+  MinCost,
+  //! Maximal flow with the largest total preference of employees, see WeightedMaxFlow.
+  Preference
+};
+
+/*!
+ * Engine that finds maximal flow in the schedule network. Flow is left in the network,
+ * so the assignments can be read from edge flows after Solve.
+ */
+class ScheduleSolver
+{
+public:
+  virtual ~ScheduleSolver() = default;
+
+  //! Finds maximal flow from source to sink and returns its value.
+  virtual int Solve(FlowNetwork & network, size_t source, size_t sink) = 0;
+
+  virtual std::string GetName() const = 0;
+
+  //! Counters of the last run, they are added to the max_flow phase metrics.
+  virtual std::vector<std::pair<std::string, size_t>> GetCounters() const = 0;
+};
+
+std::unique_ptr<ScheduleSolver> CreateScheduleSolver(ScheduleSolverType type);
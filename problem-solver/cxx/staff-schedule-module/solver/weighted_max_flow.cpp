@@ -0,0 +1,204 @@
+#include "weighted_max_flow.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+int64_t const Unreached = std::numeric_limits<int64_t>::max();
+}  // namespace
+
+WeightedMaxFlow::WeightedMaxFlow(std::vector<int> arcCosts)
+  : m_arcCosts(std::move(arcCosts))
+{
+}
+
+int WeightedMaxFlow::Solve(FlowNetwork & network, size_t source, size_t sink)
+{
+  size_t const nodeCount = network.GetNodeCount();
+  m_arcCosts.resize(2 * network.GetEdgeCount(), 0);
+  m_potential.assign(nodeCount, 0);
+  m_distance.assign(nodeCount, Unreached);
+  m_level.assign(nodeCount, -1);
+  m_currentArc.assign(nodeCount, 0);
+  m_queue.reserve(nodeCount);
+  m_phases = 0;
+  m_rounds = 0;
+  m_augmentingPaths = 0;
+
+  int flow = 0;
+  while (FindDistances(network, source, sink))
+  {
+    ++m_phases;
+    while (BuildLevels(network, source, sink))
+    {
+      ++m_rounds;
+      for (size_t node = 0; node < nodeCount; ++node)
+        m_currentArc[node] = network.ArcsBegin(node);
+
+      flow += FindBlockingFlow(network, source, sink);
+    }
+  }
+
+  // Поток ребра лежит в ёмкости обратной дуги, её стоимость противоположна стоимости ребра.
+  m_cost = 0;
+  for (size_t a = 0; a < m_arcCosts.size(); ++a)
+  {
+    if (m_arcCosts[a] < 0)
+      m_cost += static_cast<size_t>(-m_arcCosts[a]) * static_cast<size_t>(network.GetArc(a).cap);
+  }
+  return flow;
+}
+
+std::string WeightedMaxFlow::GetName() const
+{
+  return "weighted";
+}
+
+std::vector<std::pair<std::string, size_t>> WeightedMaxFlow::GetCounters() const
+{
+  return {
+      {"phases", m_phases}, {"bfs_rounds", m_rounds}, {"augmenting_paths", m_augmentingPaths}, {"cost", m_cost}};
+}
+
+size_t WeightedMaxFlow::GetCost() const
+{
+  return m_cost;
+}
+
+int64_t WeightedMaxFlow::GetReducedCost(FlowNetwork const & network, size_t node, size_t arcIndex) const
+{
+  // Отрицательная приведённая стоимость возможна только у потока, оставленного в сети до запуска.
+  int64_t const cost =
+      m_arcCosts[arcIndex] + m_potential[node] - m_potential[static_cast<size_t>(network.GetArc(arcIndex).to)];
+  return std::max<int64_t>(cost, 0);
+}
+
+bool WeightedMaxFlow::FindDistances(FlowNetwork const & network, size_t source, size_t sink)
+{
+  // Приведённые стоимости — небольшие целые, поэтому вершины раскладываются по корзинам расстояний.
+  std::fill(m_distance.begin(), m_distance.end(), Unreached);
+  m_distance[source] = 0;
+  m_buckets.assign(1, {source});
+
+  int64_t sinkDistance = Unreached;
+  for (size_t current = 0; current < m_buckets.size() && sinkDistance == Unreached; ++current)
+  {
+    // Корзина может расти, пока просматривается: дуги нулевой стоимости кладут вершины в неё же.
+    for (size_t k = 0; k < m_buckets[current].size(); ++k)
+    {
+      size_t const node = m_buckets[current][k];
+      if (m_distance[node] != static_cast<int64_t>(current))
+        continue;
+      if (node == sink)
+      {
+        sinkDistance = m_distance[node];
+        break;
+      }
+
+      for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+      {
+        FlowNetwork::Arc const & arc = network.GetArc(a);
+        if (arc.cap <= 0)
+          continue;
+        int64_t const distance = m_distance[node] + GetReducedCost(network, node, a);
+        if (distance >= m_distance[arc.to])
+          continue;
+        m_distance[arc.to] = distance;
+        if (static_cast<size_t>(distance) >= m_buckets.size())
+          m_buckets.resize(static_cast<size_t>(distance) + 1);
+        m_buckets[static_cast<size_t>(distance)].push_back(static_cast<size_t>(arc.to));
+      }
+    }
+  }
+  if (sinkDistance == Unreached)
+    return false;
+
+  // Вершины дальше стока сдвигаются на его расстояние, так приведённые стоимости остаются неотрицательными.
+  for (size_t node = 0; node < m_potential.size(); ++node)
+    m_potential[node] += std::min(m_distance[node], sinkDistance);
+  return true;
+}
+
+bool WeightedMaxFlow::IsAdmissible(FlowNetwork const & network, size_t node, size_t arcIndex) const
+{
+  return network.GetArc(arcIndex).cap > 0 && GetReducedCost(network, node, arcIndex) == 0;
+}
+
+bool WeightedMaxFlow::BuildLevels(FlowNetwork const & network, size_t source, size_t sink)
+{
+  std::fill(m_level.begin(), m_level.end(), -1);
+  m_queue.clear();
+  m_queue.push_back(source);
+  m_level[source] = 0;
+
+  for (size_t qi = 0; qi < m_queue.size(); ++qi)
+  {
+    size_t const node = m_queue[qi];
+    for (size_t a = network.ArcsBegin(node); a < network.ArcsEnd(node); ++a)
+    {
+      size_t const to = static_cast<size_t>(network.GetArc(a).to);
+      if (m_level[to] == -1 && IsAdmissible(network, node, a))
+      {
+        m_level[to] = m_level[node] + 1;
+        m_queue.push_back(to);
+      }
+    }
+  }
+  return m_level[sink] != -1;
+}
+
+int WeightedMaxFlow::FindBlockingFlow(FlowNetwork & network, size_t source, size_t sink)
+{
+  int flow = 0;
+  m_path.clear();
+  size_t node = source;
+
+  while (true)
+  {
+    if (node == sink)
+    {
+      // Все дуги пути имеют нулевую приведённую стоимость, поэтому узкое место проталкивается целиком.
+      int pushed = std::numeric_limits<int>::max();
+      for (size_t a : m_path)
+        pushed = std::min(pushed, network.GetArc(a).cap);
+      for (size_t a : m_path)
+        network.Push(a, pushed);
+
+      flow += pushed;
+      ++m_augmentingPaths;
+
+      size_t keep = 0;
+      while (keep < m_path.size() && network.GetArc(m_path[keep]).cap > 0)
+        ++keep;
+      m_path.resize(keep);
+      node = m_path.empty() ? source : static_cast<size_t>(network.GetArc(m_path.back()).to);
+      continue;
+    }
+
+    size_t & a = m_currentArc[node];
+    size_t const end = network.ArcsEnd(node);
+    while (a < end)
+    {
+      if (m_level[network.GetArc(a).to] == m_level[node] + 1 && IsAdmissible(network, node, a))
+        break;
+      ++a;
+    }
+
+    if (a < end)
+    {
+      m_path.push_back(a);
+      node = static_cast<size_t>(network.GetArc(a).to);
+      continue;
+    }
+
+    // Тупик: вершина больше не участвует в этом раунде, возвращаемся на шаг назад.
+    if (node == source)
+      break;
+    m_level[node] = -1;
+    m_path.pop_back();
+    node = m_path.empty() ? source : static_cast<size_t>(network.GetArc(m_path.back()).to);
+  }
+
+  return flow;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "solver/schedule_solver.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*!
+ * Maximal flow of minimal total cost, where every edge has its own non-negative cost per unit of flow.
+ * The builder gives assignment edges the cost of a missed preference, so among maximal flows the one
+ * with the largest total preference is found.
+ *
+ * Successive shortest paths grouped by length (primal-dual) with vertex potentials. Reduced costs are
+ * small non-negative integers, so distances are found by Dial's buckets instead of a heap, and a phase
+ * runs Dinic over arcs of zero reduced cost. The number of phases is the number of distinct lengths of
+ * shortest augmenting paths, which is bounded by the largest cost times the path length and is small
+ * for a few preference levels.
+ *
+ * Flow already in the network is kept; the result is optimal when the search starts from zero flow.
+ * Without costs every edge costs nothing and the solver finds any maximal flow.
+ */
+class WeightedMaxFlow : public ScheduleSolver
+{
+public:
+  /*!
+   * Costs by arc index of the built network: the forward arc of an edge has its cost and the residual arc
+   * the opposite one. Arcs beyond the vector cost nothing.
+   */
+  explicit WeightedMaxFlow(std::vector<int> arcCosts = {});
+
+  int Solve(FlowNetwork & network, size_t source, size_t sink) override;
+  std::string GetName() const override;
+  std::vector<std::pair<std::string, size_t>> GetCounters() const override;
+
+  //! Total cost of the flow in the network after the last run.
+  size_t GetCost() const;
+
+private:
+  //! Finds distances from the source by reduced costs and updates potentials; false if the sink is not reachable.
+  bool FindDistances(FlowNetwork const & network, size_t source, size_t sink);
+  bool BuildLevels(FlowNetwork const & network, size_t source, size_t sink);
+  int FindBlockingFlow(FlowNetwork & network, size_t source, size_t sink);
+  bool IsAdmissible(FlowNetwork const & network, size_t node, size_t arcIndex) const;
+  int64_t GetReducedCost(FlowNetwork const & network, size_t node, size_t arcIndex) const;
+
+  std::vector<int> m_arcCosts;
+  std::vector<int64_t> m_potential;
+  std::vector<int64_t> m_distance;
+  std::vector<std::vector<size_t>> m_buckets;
+  std::vector<int> m_level;
+  std::vector<size_t> m_currentArc;
+  std::vector<size_t> m_queue;
+  std::vector<size_t> m_path;
+
+  size_t m_phases = 0;
+  size_t m_rounds = 0;
+  size_t m_augmentingPaths = 0;
+  size_t m_cost = 0;
+};
@@ -1,6 +1,38 @@
 #include "staff_schedule_module.h"
 
+#include "agent/batch_build_staff_schedule_agent.hpp"
 #include "agent/build_staff_schedule_agent.hpp"
+#include "agent/find_substitute_agent.hpp"
+#include "agent/repair_staff_schedule_agent.hpp"
 
 SC_MODULE_REGISTER(StaffScheduleModule)
-  ->Agent<BuildStaffScheduleAgent>();
+  ->Agent<BuildStaffScheduleAgent>()
+  ->Agent<BatchBuildStaffScheduleAgent>()
+  ->Agent<RepairStaffScheduleAgent>()
+  ->Agent<FindSubstituteAgent>();
+
+void StaffScheduleModule::Initialize(ScMemoryContext * context)
+{
+  ScModule::Initialize(context);
+  GetStaffDataCache().Subscribe();
+  GetScheduleMaintainer().Start();
+}
+
+void StaffScheduleModule::Shutdown(ScMemoryContext * context)
+{
+  GetScheduleMaintainer().Stop();
+  GetStaffDataCache().Unsubscribe();
+  ScModule::Shutdown(context);
+}
+
+StaffDataCache & StaffScheduleModule::GetStaffDataCache()
+{
+  static StaffDataCache cache;
+  return cache;
+}
+
+StaffScheduleMaintainer & StaffScheduleModule::GetScheduleMaintainer()
+{
+  static StaffScheduleMaintainer maintainer;
+  return maintainer;
+}
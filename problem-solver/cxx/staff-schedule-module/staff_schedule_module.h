@@ -2,6 +2,18 @@
 
 #include <sc-memory/sc_module.hpp>
 
+#include "cache/staff_data_cache.hpp"
+#include "maintenance/staff_schedule_maintainer.hpp"
+
 class StaffScheduleModule : public ScModule
 {
+public:
+  void Initialize(ScMemoryContext * context) override;
+  void Shutdown(ScMemoryContext * context) override;
+
+  //! Staff data shared by schedule builds; enabled while the module is initialized.
+  static StaffDataCache & GetStaffDataCache();
+
+  //! Repairs current schedules after staff changes; running while the module is initialized.
+  static StaffScheduleMaintainer & GetScheduleMaintainer();
 };
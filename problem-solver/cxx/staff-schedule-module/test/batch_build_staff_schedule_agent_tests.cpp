@@ -0,0 +1,102 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_iterator.hpp>
+
+#include "agent/batch_build_staff_schedule_agent.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <string>
+
+using BatchAgentTest = ScMemoryTest;
+
+namespace
+{
+ScAddr CreateStaffedRestaurant(ScMemoryContext & ctx)
+{
+  ScAddr restaurant = CreateRestaurant(ctx);
+  ScAddr shiftType = CreateShiftType(ctx);
+  for (ScAddr const & role :
+       {StaffScheduleKeynodes::concept_cook,
+        StaffScheduleKeynodes::concept_waiter,
+        StaffScheduleKeynodes::concept_waiter,
+        StaffScheduleKeynodes::concept_cleaner,
+        StaffScheduleKeynodes::concept_admin})
+    AddEmployeeToRestaurant(ctx, restaurant, CreateEmployee(ctx, role, shiftType));
+  CreateShift(ctx, shiftType);
+  return restaurant;
+}
+
+ScAddr GetCurrentSchedule(ScMemoryContext & ctx, ScAddr const & restaurant)
+{
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      restaurant,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  return it->Next() ? it->Get(2) : ScAddr::Empty;
+}
+
+std::string GetBatchMetrics(ScMemoryContext & ctx, ScAddr const & result)
+{
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      result,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_schedule_metrics);
+  std::string value;
+  if (!it->Next() || !ctx.GetLinkContent(it->Get(2), value))
+    return "";
+  return value;
+}
+}  // namespace
+
+TEST_F(BatchAgentTest, BatchBuildStaffScheduleAgentBuildsEveryRestaurant)
+{
+  m_ctx->SubscribeAgent<BatchBuildStaffScheduleAgent>();
+
+  ScAddr first = CreateStaffedRestaurant(*m_ctx);
+  ScAddr second = CreateStaffedRestaurant(*m_ctx);
+  ScAddr empty = CreateRestaurant(*m_ctx);
+
+  ScAddr restaurants = m_ctx->GenerateNode(ScType::ConstNode);
+  for (ScAddr const & restaurant : {first, second, empty})
+    m_ctx->GenerateConnector(ScType::ConstPermPosArc, restaurants, restaurant);
+
+  ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_batch_build_staff_schedule);
+  action.SetArguments(restaurants);
+
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  ScAddr firstSchedule = GetCurrentSchedule(*m_ctx, first);
+  ScAddr secondSchedule = GetCurrentSchedule(*m_ctx, second);
+  EXPECT_TRUE(m_ctx->IsElement(firstSchedule));
+  EXPECT_TRUE(m_ctx->IsElement(secondSchedule));
+  EXPECT_NE(firstSchedule, secondSchedule);
+  EXPECT_FALSE(m_ctx->IsElement(GetCurrentSchedule(*m_ctx, empty)));
+
+  ScAddr result = action.GetResult();
+  EXPECT_TRUE(m_ctx->CheckConnector(result, firstSchedule, ScType::ConstPermPosArc));
+  EXPECT_TRUE(m_ctx->CheckConnector(result, secondSchedule, ScType::ConstPermPosArc));
+  EXPECT_NE(GetBatchMetrics(*m_ctx, result).find("\"schedules\":2"), std::string::npos);
+
+  m_ctx->UnsubscribeAgent<BatchBuildStaffScheduleAgent>();
+}
+
+TEST_F(BatchAgentTest, BatchBuildStaffScheduleAgentNeedsRestaurants)
+{
+  m_ctx->SubscribeAgent<BatchBuildStaffScheduleAgent>();
+
+  ScAddr restaurants = m_ctx->GenerateNode(ScType::ConstNode);
+  ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_batch_build_staff_schedule);
+  action.SetArguments(restaurants);
+
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_FALSE(action.IsFinishedSuccessfully());
+
+  m_ctx->UnsubscribeAgent<BatchBuildStaffScheduleAgent>();
+}
@@ -5,65 +5,15 @@
 
 #include "agent/build_staff_schedule_agent.hpp"
 #include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <set>
+#include <string>
 
 using AgentTest = ScMemoryTest;
 
 namespace
 {
-void AddRelation(ScMemoryContext & ctx, ScAddr const & src, ScAddr const & trg, ScAddr const & rel)
-{
-  ScAddr arc = ctx.GenerateConnector(ScType::ConstCommonArc, src, trg);
-  ctx.GenerateConnector(ScType::ConstPermPosArc, rel, arc);
-}
-
-ScAddr CreateShiftType(ScMemoryContext & ctx)
-{
-  ScAddr shiftType = ctx.GenerateNode(ScType::ConstNode);
-  ctx.GenerateConnector(
-      ScType::ConstPermPosArc,
-      StaffScheduleKeynodes::concept_shift_type,
-      shiftType);
-  return shiftType;
-}
-
-ScAddr CreateEmployeeWithMax(
-    ScMemoryContext & ctx,
-    ScAddr const & role,
-    ScAddr const & availableShiftType,
-    std::string const & maxShifts)
-{
-  ScAddr employee = ctx.GenerateNode(ScType::ConstNode);
-  ctx.GenerateConnector(
-      ScType::ConstPermPosArc,
-      StaffScheduleKeynodes::concept_employee,
-      employee);
-
-  AddRelation(ctx, employee, role, StaffScheduleKeynodes::nrel_has_role);
-  AddRelation(ctx, employee, availableShiftType, StaffScheduleKeynodes::nrel_available_shift_type);
-
-  ScAddr maxLink = ctx.GenerateLink();
-  ctx.SetLinkContent(maxLink, maxShifts);
-  AddRelation(ctx, employee, maxLink, StaffScheduleKeynodes::nrel_max_shifts_per_week);
-
-  return employee;
-}
-
-ScAddr CreateEmployee(ScMemoryContext & ctx, ScAddr const & role, ScAddr const & availableShiftType)
-{
-  return CreateEmployeeWithMax(ctx, role, availableShiftType, "5");
-}
-
-ScAddr CreateShift(ScMemoryContext & ctx, ScAddr const & shiftType)
-{
-  ScAddr shift = ctx.GenerateNode(ScType::ConstNode);
-  ctx.GenerateConnector(
-      ScType::ConstPermPosArc,
-      StaffScheduleKeynodes::concept_shift,
-      shift);
-  AddRelation(ctx, shift, shiftType, StaffScheduleKeynodes::nrel_shift_type);
-  return shift;
-}
-
 size_t GetShiftCount(ScMemoryContext & ctx, ScAddr const & employee)
 {
   ScIterator5Ptr it = ctx.CreateIterator5(
@@ -100,29 +50,28 @@ bool HasCanWork(ScMemoryContext & ctx, ScAddr const & employee, ScAddr const & s
   return it->Next();
 }
 
-ScAddr CreateRestaurant(ScMemoryContext & ctx)
+size_t GetCanWorkCount(ScMemoryContext & ctx, ScAddr const & employee)
 {
-  ScAddr restaurant = ctx.GenerateNode(ScType::ConstNode);
-  ctx.GenerateConnector(
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      employee,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
       ScType::ConstPermPosArc,
-      StaffScheduleKeynodes::concept_restaurant,
-      restaurant);
-  return restaurant;
-}
-
-void AddEmployeeToRestaurant(ScMemoryContext & ctx, ScAddr const & restaurant, ScAddr const & employee)
-{
-  AddRelation(ctx, restaurant, employee, StaffScheduleKeynodes::nrel_has_employee);
+      StaffScheduleKeynodes::nrel_can_work);
+  size_t count = 0;
+  while (it->Next())
+    count++;
+  return count;
 }
 
-std::string GetAllShiftsStaffed(ScMemoryContext & ctx)
+std::string GetScheduleLinkContent(ScMemoryContext & ctx, ScAddr const & relation)
 {
   ScIterator5Ptr it = ctx.CreateIterator5(
       ScType::ConstNode,
       ScType::ConstCommonArc,
       ScType::ConstNodeLink,
       ScType::ConstPermPosArc,
-      StaffScheduleKeynodes::nrel_all_shifts_staffed);
+      relation);
   if (!it->Next())
     return "";
 
@@ -131,6 +80,98 @@ std::string GetAllShiftsStaffed(ScMemoryContext & ctx)
     return "";
   return value;
 }
+
+std::string GetAllShiftsStaffed(ScMemoryContext & ctx)
+{
+  return GetScheduleLinkContent(ctx, StaffScheduleKeynodes::nrel_all_shifts_staffed);
+}
+
+size_t GetEmployeeSlotCount(ScMemoryContext & ctx)
+{
+  ScIterator3Ptr it = ctx.CreateIterator3(
+      StaffScheduleKeynodes::concept_employee_slot,
+      ScType::ConstPermPosArc,
+      ScType::ConstNode);
+  size_t count = 0;
+  while (it->Next())
+    count++;
+  return count;
+}
+
+std::string GetScheduleMetrics(ScMemoryContext & ctx)
+{
+  return GetScheduleLinkContent(ctx, StaffScheduleKeynodes::nrel_schedule_metrics);
+}
+
+size_t CountOutgoing(ScMemoryContext & ctx, ScAddr const & source, ScAddr const & relation)
+{
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      source,
+      ScType::ConstCommonArc,
+      ScType::Unknown,
+      ScType::ConstPermPosArc,
+      relation);
+  size_t count = 0;
+  while (it->Next())
+    count++;
+  return count;
+}
+
+size_t GetWeekScheduleCount(ScMemoryContext & ctx)
+{
+  ScIterator3Ptr it = ctx.CreateIterator3(
+      StaffScheduleKeynodes::concept_week_schedule,
+      ScType::ConstPermPosArc,
+      ScType::ConstNode);
+  size_t count = 0;
+  while (it->Next())
+    count++;
+  return count;
+}
+
+/*!
+ * Result elements without their addresses: given elements by address, other nodes and links by kind,
+ * arcs of schedule relations by relation and ends.
+ */
+std::multiset<std::string> DescribeResult(
+    ScMemoryContext & ctx,
+    ScStructure const & result,
+    std::set<ScAddr, ScAddrLessFunc> const & given)
+{
+  auto const describe = [&](ScAddr const & element) -> std::string {
+    if (given.count(element) != 0)
+      return std::to_string(element.Hash());
+    return ctx.GetElementType(element).IsLink() ? "link" : "node";
+  };
+
+  std::multiset<std::string> description;
+  ScIterator3Ptr it = ctx.CreateIterator3(result, ScType::ConstPermPosArc, ScType::Unknown);
+  while (it->Next())
+  {
+    ScAddr const & element = it->Get(2);
+    if (!ctx.GetElementType(element).IsConnector())
+    {
+      description.insert(describe(element));
+      continue;
+    }
+
+    std::string relationName = "arc";
+    for (auto const & [relation, name] :
+         {std::pair(StaffScheduleKeynodes::nrel_current_schedule, "current_schedule"),
+          std::pair(StaffScheduleKeynodes::nrel_assigned_employee, "assigned_employee"),
+          std::pair(StaffScheduleKeynodes::nrel_reserve_employee, "reserve_employee"),
+          std::pair(StaffScheduleKeynodes::nrel_employee_schedule, "employee_schedule"),
+          std::pair(StaffScheduleKeynodes::nrel_shift_count, "shift_count"),
+          std::pair(StaffScheduleKeynodes::nrel_schedule_metrics, "schedule_metrics")})
+    {
+      if (ctx.CheckConnector(relation, element, ScType::ConstPermPosArc))
+        relationName = name;
+    }
+    auto const [source, target] = ctx.GetConnectorIncidentElements(element);
+    description.insert(relationName + ":" + describe(source) + ":" + describe(target));
+  }
+  return description;
+}
 }
 
 TEST_F(AgentTest, BuildStaffScheduleAgentBasic)
@@ -457,3 +498,329 @@ TEST_F(AgentTest, BuildStaffScheduleAgentNotEnoughStaff)
 
   m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
 }
+
+TEST_F(AgentTest, BuildStaffScheduleAgentWritesMetrics)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  CreateShift(*m_ctx, dayType);
+
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  ScAddr waiter = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, waiter);
+
+  ScAction action = m_ctx->GenerateAction(
+      StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant);
+
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  std::string metrics = GetScheduleMetrics(*m_ctx);
+  EXPECT_NE(metrics.find("\"read_staff_data\""), std::string::npos);
+  EXPECT_NE(metrics.find("\"can_work_arcs\""), std::string::npos);
+  EXPECT_EQ(metrics.find("\"employee_slots\""), std::string::npos);
+  EXPECT_NE(metrics.find("\"flow_network\""), std::string::npos);
+  EXPECT_NE(metrics.find("\"max_flow\""), std::string::npos);
+  EXPECT_NE(metrics.find("\"write_schedule\""), std::string::npos);
+  EXPECT_NE(metrics.find("\"bfs_rounds\""), std::string::npos);
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(AgentTest, BuildStaffScheduleAgentUsesGivenSolver)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayType);
+
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  ScAddr waiter1 = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+  ScAddr waiter2 = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+  ScAddr cleaner = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cleaner, dayType);
+  ScAddr admin = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_admin, dayType);
+
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, waiter1);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, waiter2);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cleaner);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, admin);
+
+  ScAction action = m_ctx->GenerateAction(
+      StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant, StaffScheduleKeynodes::concept_solver_push_relabel);
+
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  ScIterator5Ptr itAssigned = m_ctx->CreateIterator5(
+      shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_assigned_employee);
+
+  size_t assignedCount = 0;
+  while (itAssigned->Next())
+  {
+    assignedCount++;
+  }
+
+  EXPECT_EQ(assignedCount, 5u);
+  EXPECT_EQ(GetAllShiftsStaffed(*m_ctx), "true");
+  EXPECT_NE(GetScheduleMetrics(*m_ctx).find("\"pushes\""), std::string::npos);
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(AgentTest, BuildStaffScheduleAgentBalancesLoadWithMinCostSolver)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  CreateShift(*m_ctx, dayType);
+  CreateShift(*m_ctx, dayType);
+
+  // Каждой смене нужен один повар, оба повара могут работать в обеих сменах.
+  ScAddr cook1 = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  ScAddr cook2 = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook1);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook2);
+
+  ScAction action = m_ctx->GenerateAction(
+      StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant, StaffScheduleKeynodes::concept_solver_min_cost);
+
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+
+  EXPECT_EQ(GetShiftCount(*m_ctx, cook1), 1u);
+  EXPECT_EQ(GetShiftCount(*m_ctx, cook2), 1u);
+  EXPECT_EQ(GetScheduleLinkContent(*m_ctx, StaffScheduleKeynodes::nrel_shift_count_deviation), "0.00");
+  EXPECT_NE(GetScheduleMetrics(*m_ctx).find("\"cost\":2"), std::string::npos);
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(AgentTest, BuildStaffScheduleAgentWritesEmployeeSlotsOnlyForDebugGraph)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  CreateShift(*m_ctx, dayType);
+
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+
+  ScAction action = m_ctx->GenerateAction(
+      StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant);
+
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+  EXPECT_EQ(GetEmployeeSlotCount(*m_ctx), 0u);
+
+  ScAction debugAction = m_ctx->GenerateAction(
+      StaffScheduleKeynodes::action_build_staff_schedule);
+  debugAction.SetArguments(restaurant);
+  m_ctx->GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::concept_schedule_debug_graph,
+      debugAction);
+
+  EXPECT_TRUE(debugAction.InitiateAndWait());
+  EXPECT_TRUE(debugAction.IsFinishedSuccessfully());
+  // Один слот на каждую смену из недельного лимита сотрудника (по умолчанию 5).
+  EXPECT_EQ(GetEmployeeSlotCount(*m_ctx), 5u);
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(AgentTest, BuildStaffScheduleAgentUpdatesCanWorkIncrementally)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  ScAddr dayShift = CreateShift(*m_ctx, dayType);
+  ScAddr nightShift = CreateShift(*m_ctx, nightType);
+  ScAddr lateShift = CreateShift(*m_ctx, dayType);
+  for (ScAddr const & shift : {dayShift, nightShift, lateShift})
+    AddShiftToRestaurant(*m_ctx, restaurant, shift);
+
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  AddRelation(*m_ctx, cook, nightType, StaffScheduleKeynodes::nrel_available_shift_type);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+  ScAddr waiter = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, waiter);
+
+  auto const build = [this, &restaurant]() {
+    ScAction action = m_ctx->GenerateAction(
+        StaffScheduleKeynodes::action_build_staff_schedule);
+    action.SetArguments(restaurant);
+    EXPECT_TRUE(action.InitiateAndWait());
+    EXPECT_TRUE(action.IsFinishedSuccessfully());
+  };
+  auto const eraseRelation = [this](ScAddr const & source, ScAddr const & target, ScAddr const & relation) {
+    ScIterator5Ptr it = m_ctx->CreateIterator5(
+        source,
+        ScType::ConstCommonArc,
+        target,
+        ScType::ConstPermPosArc,
+        relation);
+    ASSERT_TRUE(it->Next());
+    m_ctx->EraseElement(it->Get(1));
+  };
+
+  for (size_t run = 0; run < 2; ++run)
+  {
+    build();
+    EXPECT_EQ(GetCanWorkCount(*m_ctx, cook), 3u);
+    EXPECT_EQ(GetCanWorkCount(*m_ctx, waiter), 2u);
+  }
+
+  // Сотрудник больше не работает ночью: дуга к ночной смене должна исчезнуть.
+  eraseRelation(cook, nightType, StaffScheduleKeynodes::nrel_available_shift_type);
+  build();
+
+  EXPECT_EQ(GetCanWorkCount(*m_ctx, cook), 2u);
+  EXPECT_TRUE(HasCanWork(*m_ctx, cook, dayShift));
+  EXPECT_FALSE(HasCanWork(*m_ctx, cook, nightShift));
+
+  // Официант ушёл из ресторана, а поздняя смена из него убрана: их дуги тоже должны исчезнуть.
+  eraseRelation(restaurant, waiter, StaffScheduleKeynodes::nrel_has_employee);
+  eraseRelation(restaurant, lateShift, StaffScheduleKeynodes::nrel_has_shift);
+  build();
+
+  EXPECT_EQ(GetCanWorkCount(*m_ctx, waiter), 0u);
+  EXPECT_EQ(GetCanWorkCount(*m_ctx, cook), 1u);
+  EXPECT_TRUE(HasCanWork(*m_ctx, cook, dayShift));
+  EXPECT_FALSE(HasCanWork(*m_ctx, cook, lateShift));
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(AgentTest, BuildStaffScheduleAgentUpdatesCurrentScheduleInPlace)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayType);
+
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  ScAddr waiter1 = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+  ScAddr waiter2 = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+  ScAddr cleaner = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cleaner, dayType);
+  ScAddr admin = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_admin, dayType);
+  for (ScAddr const & employee : {cook, waiter1, waiter2, cleaner, admin})
+    AddEmployeeToRestaurant(*m_ctx, restaurant, employee);
+
+  auto const runInPlace = [this, &restaurant]() {
+    ScAction action = m_ctx->GenerateAction(
+        StaffScheduleKeynodes::action_build_staff_schedule);
+    action.SetArguments(restaurant);
+    m_ctx->GenerateConnector(
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::concept_schedule_update_in_place,
+        action);
+    EXPECT_TRUE(action.InitiateAndWait());
+    EXPECT_TRUE(action.IsFinishedSuccessfully());
+  };
+
+  runInPlace();
+  ScIterator5Ptr itCurrent = m_ctx->CreateIterator5(
+      restaurant,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  ASSERT_TRUE(itCurrent->Next());
+  ScAddr const schedule = itCurrent->Get(2);
+  // Недельные расписания сотрудников входят в тот же класс, что и график ресторана.
+  size_t const scheduleCount = GetWeekScheduleCount(*m_ctx);
+  EXPECT_EQ(scheduleCount, 6u);
+  EXPECT_EQ(CountOutgoing(*m_ctx, shift, StaffScheduleKeynodes::nrel_assigned_employee), 5u);
+
+  // Повторные запуски без изменений не добавляют ни графиков, ни назначений, ни ссылок.
+  for (size_t run = 0; run < 3; ++run)
+  {
+    runInPlace();
+    EXPECT_EQ(GetWeekScheduleCount(*m_ctx), scheduleCount);
+    EXPECT_EQ(CountOutgoing(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_current_schedule), 1u);
+    EXPECT_EQ(CountOutgoing(*m_ctx, shift, StaffScheduleKeynodes::nrel_assigned_employee), 5u);
+    EXPECT_EQ(CountOutgoing(*m_ctx, cook, StaffScheduleKeynodes::nrel_shift_count), 1u);
+    EXPECT_EQ(CountOutgoing(*m_ctx, schedule, StaffScheduleKeynodes::nrel_schedule_metrics), 1u);
+  }
+  EXPECT_NE(GetScheduleMetrics(*m_ctx).find("\"assignments_added\":0"), std::string::npos);
+
+  // Назначение, расписание и счётчик смен ушедшего сотрудника удаляются из того же графика.
+  ScIterator5Ptr itEmployee = m_ctx->CreateIterator5(
+      restaurant,
+      ScType::ConstCommonArc,
+      waiter2,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_employee);
+  ASSERT_TRUE(itEmployee->Next());
+  m_ctx->EraseElement(itEmployee->Get(1));
+
+  runInPlace();
+  EXPECT_EQ(GetWeekScheduleCount(*m_ctx), scheduleCount - 1);
+  EXPECT_EQ(CountOutgoing(*m_ctx, waiter2, StaffScheduleKeynodes::nrel_shift_count), 0u);
+  EXPECT_EQ(CountOutgoing(*m_ctx, shift, StaffScheduleKeynodes::nrel_assigned_employee), 4u);
+  EXPECT_EQ(GetShiftCount(*m_ctx, waiter1), 1u);
+  EXPECT_NE(GetScheduleMetrics(*m_ctx).find("\"assignments_removed\":1"), std::string::npos);
+  EXPECT_EQ(GetAllShiftsStaffed(*m_ctx), "false");
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(AgentTest, BuildStaffScheduleAgentReturnsWholeScheduleWhenUpdatingInPlace)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  ScAddr dayShift = CreateShift(*m_ctx, dayType);
+  ScAddr nightShift = CreateShift(*m_ctx, nightType);
+  AddShiftToRestaurant(*m_ctx, restaurant, dayShift);
+  AddShiftToRestaurant(*m_ctx, restaurant, nightShift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_reserve_count, "1");
+
+  // Ночную смену никто не может взять, поэтому в графике есть и резерв, и проблема укомплектования.
+  std::set<ScAddr, ScAddrLessFunc> given{restaurant, dayShift, nightShift};
+  for (size_t i = 0; i < 2; ++i)
+  {
+    ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+    given.insert(cook);
+  }
+
+  auto const build = [&](bool inPlace) {
+    ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_build_staff_schedule);
+    action.SetArguments(restaurant);
+    if (inPlace)
+      m_ctx->GenerateConnector(
+          ScType::ConstPermPosArc, StaffScheduleKeynodes::concept_schedule_update_in_place, action);
+    EXPECT_TRUE(action.InitiateAndWait());
+    EXPECT_TRUE(action.IsFinishedSuccessfully());
+    return DescribeResult(*m_ctx, action.GetResult(), given);
+  };
+
+  std::multiset<std::string> const written = build(false);
+  EXPECT_EQ(written.count("current_schedule:" + std::to_string(restaurant.Hash()) + ":node"), 1u);
+  EXPECT_EQ(build(true), written);
+
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "model/employee_bitset.hpp"
+
+#include <vector>
+
+TEST(EmployeeBitsetTest, SetOperationsAcrossWords)
+{
+  EmployeeBitset available(130);
+  EmployeeBitset role(130);
+  for (size_t i : {0, 63, 64, 100, 129})
+    available.Set(i);
+  for (size_t i : {1, 63, 64, 129})
+    role.Set(i);
+
+  EmployeeBitset candidates = available;
+  candidates &= role;
+  EXPECT_EQ(candidates.Count(), 3u);
+  EXPECT_TRUE(candidates.Test(63));
+  EXPECT_TRUE(candidates.Test(64));
+  EXPECT_FALSE(candidates.Test(100));
+
+  std::vector<size_t> indices;
+  candidates.ForEach([&](size_t i) {
+    indices.push_back(i);
+  });
+  EXPECT_EQ(indices, (std::vector<size_t>{63, 64, 129}));
+
+  EmployeeBitset assigned(130);
+  assigned.Set(63);
+  indices.clear();
+  candidates.ForEachNotIn(assigned, [&](size_t i) {
+    indices.push_back(i);
+  });
+  EXPECT_EQ(indices, (std::vector<size_t>{64, 129}));
+  assigned.Set(64);
+  assigned.Set(129);
+  indices.clear();
+  candidates.ForEachNotIn(assigned, [&](size_t i) {
+    indices.push_back(i);
+  });
+  EXPECT_TRUE(indices.empty());
+}
@@ -0,0 +1,290 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_iterator.hpp>
+
+#include "agent/build_staff_schedule_agent.hpp"
+#include "agent/find_substitute_agent.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using SubstituteAgentTest = ScMemoryTest;
+
+namespace
+{
+ScAddr GetTarget(ScMemoryContext & ctx, ScAddr const & source, ScAddr const & relation)
+{
+  ScIterator5Ptr it =
+      ctx.CreateIterator5(source, ScType::ConstCommonArc, ScType::ConstNode, ScType::ConstPermPosArc, relation);
+  return it->Next() ? it->Get(2) : ScAddr::Empty;
+}
+
+std::vector<ScAddr> GetTargets(ScMemoryContext & ctx, ScAddr const & source, ScAddr const & relation)
+{
+  std::vector<ScAddr> targets;
+  ScIterator5Ptr it =
+      ctx.CreateIterator5(source, ScType::ConstCommonArc, ScType::ConstNode, ScType::ConstPermPosArc, relation);
+  while (it->Next())
+    targets.push_back(it->Get(2));
+  return targets;
+}
+
+void BuildSchedule(ScMemoryContext & ctx, ScAddr const & restaurant)
+{
+  ScAction action = ctx.GenerateAction(StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant);
+  ctx.GenerateConnector(ScType::ConstPermPosArc, StaffScheduleKeynodes::concept_schedule_update_in_place, action);
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedSuccessfully());
+}
+
+//! Substitution returned by the query, or an empty address if it finished without one.
+ScAddr FindSubstitution(ScMemoryContext & ctx, ScAddr const & shift, ScAddr const & employee)
+{
+  ScAction action = ctx.GenerateAction(StaffScheduleKeynodes::action_find_substitute);
+  action.SetArguments(shift, employee);
+  if (!action.InitiateAndWait() || !action.IsFinishedSuccessfully())
+    return ScAddr::Empty;
+
+  ScStructure result = action.GetResult();
+  ScIterator3Ptr it = ctx.CreateIterator3(result, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (it->Next())
+  {
+    if (ctx.CheckConnector(StaffScheduleKeynodes::concept_substitution, it->Get(2), ScType::ConstPermPosArc))
+      return it->Get(2);
+  }
+  return ScAddr::Empty;
+}
+
+struct Move
+{
+  ScAddr employee;
+  ScAddr from;
+  ScAddr to;
+};
+
+std::vector<Move> GetMoves(ScMemoryContext & ctx, ScAddr const & substitution)
+{
+  std::vector<Move> moves;
+  ScIterator3Ptr itMove = ctx.CreateIterator3(substitution, ScType::ConstPermPosArc, ScType::ConstNode);
+  while (itMove->Next())
+  {
+    moves.push_back(
+        {GetTarget(ctx, itMove->Get(2), StaffScheduleKeynodes::nrel_moved_employee),
+         GetTarget(ctx, itMove->Get(2), StaffScheduleKeynodes::nrel_from_shift),
+         GetTarget(ctx, itMove->Get(2), StaffScheduleKeynodes::nrel_to_shift)});
+  }
+  return moves;
+}
+
+//! Assignments by shift after the moves: every employee leaves the shift they had and takes the new one.
+std::map<ScAddr, ScAddr, ScAddrLessFunc> ApplyMoves(
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> assigned,
+    ScAddr const & freedShift,
+    std::vector<Move> const & moves)
+{
+  assigned[freedShift] = ScAddr::Empty;
+  for (Move const & move : moves)
+  {
+    if (move.from.IsValid())
+    {
+      EXPECT_EQ(assigned[move.from], move.employee);
+      assigned[move.from] = ScAddr::Empty;
+    }
+    assigned[move.to] = move.employee;
+  }
+  return assigned;
+}
+}  // namespace
+
+TEST_F(SubstituteAgentTest, SubstitutionKeepsEveryShiftStaffed)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<FindSubstituteAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  ScAddr dayShift = CreateShift(*m_ctx, dayType);
+  ScAddr nightShift = CreateShift(*m_ctx, nightType);
+  AddShiftToRestaurant(*m_ctx, restaurant, dayShift);
+  AddShiftToRestaurant(*m_ctx, restaurant, nightShift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_substitute_count, "2");
+
+  // Один повар на три: при любом максимальном потоке у каждого назначенного есть замена,
+  // но иногда она требует перевести другого повара с его смены.
+  ScAddr dayCook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType, "1");
+  ScAddr anyCook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType, "1");
+  AddRelation(*m_ctx, anyCook, nightType, StaffScheduleKeynodes::nrel_available_shift_type);
+  ScAddr nightCook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, nightType, "1");
+  for (ScAddr const & cook : {dayCook, anyCook, nightCook})
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+
+  std::map<ScAddr, std::set<ScAddr, ScAddrLessFunc>, ScAddrLessFunc> const available = {
+      {dayCook, {dayShift}}, {anyCook, {dayShift, nightShift}}, {nightCook, {nightShift}}};
+
+  // Повторная сборка на месте заменяет прежние замены, а не добавляет новые.
+  BuildSchedule(*m_ctx, restaurant);
+  BuildSchedule(*m_ctx, restaurant);
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> assigned;
+  for (ScAddr const & shift : {dayShift, nightShift})
+  {
+    ScIterator5Ptr itAssigned = m_ctx->CreateIterator5(
+        shift,
+        ScType::ConstCommonArc,
+        ScType::ConstNode,
+        ScType::ConstPermPosArc,
+        StaffScheduleKeynodes::nrel_assigned_employee);
+    ASSERT_TRUE(itAssigned->Next());
+    assigned[shift] = itAssigned->Get(2);
+    EXPECT_EQ(GetTargets(*m_ctx, itAssigned->Get(1), StaffScheduleKeynodes::nrel_substitutes).size(), 1u);
+    EXPECT_FALSE(itAssigned->Next());
+  }
+
+  for (auto const & [shift, employee] : assigned)
+  {
+    ScAddr const substitution = FindSubstitution(*m_ctx, shift, employee);
+    ASSERT_TRUE(m_ctx->IsElement(substitution));
+    ScAddr const substitute = GetTarget(*m_ctx, substitution, StaffScheduleKeynodes::nrel_substitute);
+    EXPECT_NE(substitute, employee);
+
+    std::vector<Move> const moves = GetMoves(*m_ctx, substitution);
+    bool substituteMoved = false;
+    for (Move const & move : moves)
+    {
+      EXPECT_NE(move.employee, employee);
+      EXPECT_EQ(available.at(move.employee).count(move.to), 1u);
+      substituteMoved |= move.employee == substitute && move.to == shift;
+    }
+    EXPECT_TRUE(substituteMoved);
+    std::map<ScAddr, ScAddr, ScAddrLessFunc> const after = ApplyMoves(assigned, shift, moves);
+
+    // Каждая смена снова укомплектована, и никто не работает больше одной смены.
+    std::set<ScAddr, ScAddrLessFunc> working;
+    for (auto const & [afterShift, afterEmployee] : after)
+    {
+      EXPECT_TRUE(m_ctx->IsElement(afterEmployee));
+      EXPECT_TRUE(working.insert(afterEmployee).second);
+    }
+  }
+
+  m_ctx->UnsubscribeAgent<FindSubstituteAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(SubstituteAgentTest, SubstitutesAreWrittenOnlyWhenRequested)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<FindSubstituteAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayType);
+  AddShiftToRestaurant(*m_ctx, restaurant, shift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  ScAddr spareCook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, spareCook);
+
+  BuildSchedule(*m_ctx, restaurant);
+  ScAddr const assignee = GetTarget(*m_ctx, shift, StaffScheduleKeynodes::nrel_assigned_employee);
+  ASSERT_TRUE(m_ctx->IsElement(assignee));
+
+  ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_find_substitute);
+  action.SetArguments(shift, assignee);
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_TRUE(action.IsFinishedUnsuccessfully());
+
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_substitute_count, "1");
+  BuildSchedule(*m_ctx, restaurant);
+  ScAddr const substitution = FindSubstitution(*m_ctx, shift, assignee);
+  ASSERT_TRUE(m_ctx->IsElement(substitution));
+  EXPECT_EQ(
+      GetTarget(*m_ctx, substitution, StaffScheduleKeynodes::nrel_substitute), assignee == cook ? spareCook : cook);
+
+  m_ctx->UnsubscribeAgent<FindSubstituteAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(SubstituteAgentTest, SubstitutionKeepsTheDailyLimit)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<FindSubstituteAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr morningType = CreateShiftType(*m_ctx);
+  ScAddr eveningType = CreateShiftType(*m_ctx);
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> shiftDays;
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> shiftTypes;
+  for (size_t k = 0; k < 2; ++k)
+  {
+    ScAddr day = m_ctx->GenerateNode(ScType::ConstNode);
+    for (ScAddr const & shiftType : {morningType, eveningType})
+    {
+      ScAddr shift = CreateShift(*m_ctx, shiftType);
+      AddRelation(*m_ctx, shift, day, StaffScheduleKeynodes::nrel_shift_day);
+      AddShiftToRestaurant(*m_ctx, restaurant, shift);
+      shiftDays[shift] = day;
+      shiftTypes[shift] = shiftType;
+    }
+  }
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_substitute_count, "3");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_max_shifts_per_day, "1");
+
+  // Один повар работает в любую смену, но не больше одной в день; остальные — по одной смене в неделю.
+  std::map<ScAddr, std::set<ScAddr, ScAddrLessFunc>, ScAddrLessFunc> available;
+  ScAddr anyCook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType);
+  AddRelation(*m_ctx, anyCook, eveningType, StaffScheduleKeynodes::nrel_available_shift_type);
+  available[anyCook] = {morningType, eveningType};
+  for (ScAddr const & shiftType : {morningType, eveningType, eveningType})
+    available[CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, shiftType, "1")] = {shiftType};
+  for (auto const & [cook, types] : available)
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+
+  BuildSchedule(*m_ctx, restaurant);
+
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> assigned;
+  for (auto const & [shift, day] : shiftDays)
+  {
+    assigned[shift] = GetTarget(*m_ctx, shift, StaffScheduleKeynodes::nrel_assigned_employee);
+    ASSERT_TRUE(m_ctx->IsElement(assigned[shift]));
+  }
+
+  // Каждая найденная замена оставляет смены укомплектованными и не даёт никому двух смен в один день.
+  // Поиск строит одно дерево путей, поэтому путь к замене может идти через выбывшего и не найтись.
+  size_t substitutionCount = 0;
+  for (auto const & [shift, employee] : assigned)
+  {
+    ScAddr const substitution = FindSubstitution(*m_ctx, shift, employee);
+    if (!m_ctx->IsElement(substitution))
+      continue;
+    ++substitutionCount;
+
+    std::vector<Move> const moves = GetMoves(*m_ctx, substitution);
+    for (Move const & move : moves)
+    {
+      EXPECT_NE(move.employee, employee);
+      EXPECT_EQ(available.at(move.employee).count(shiftTypes.at(move.to)), 1u);
+    }
+
+    std::map<ScAddr, std::set<ScAddr, ScAddrLessFunc>, ScAddrLessFunc> workingDays;
+    for (auto const & [afterShift, afterEmployee] : ApplyMoves(assigned, shift, moves))
+    {
+      EXPECT_TRUE(m_ctx->IsElement(afterEmployee));
+      EXPECT_TRUE(workingDays[afterEmployee].insert(shiftDays.at(afterShift)).second);
+    }
+  }
+  EXPECT_GT(substitutionCount, 0u);
+
+  m_ctx->UnsubscribeAgent<FindSubstituteAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
@@ -0,0 +1,299 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_iterator.hpp>
+
+#include "agent/build_staff_schedule_agent.hpp"
+#include "agent/repair_staff_schedule_agent.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using RepairAgentTest = ScMemoryTest;
+
+namespace
+{
+struct Staff
+{
+  ScAddr restaurant;
+  ScAddr shiftType;
+  ScAddr shift;
+};
+
+Staff CreateStaff(ScMemoryContext & ctx)
+{
+  Staff staff;
+  staff.restaurant = CreateRestaurant(ctx);
+  staff.shiftType = CreateShiftType(ctx);
+  staff.shift = CreateShift(ctx, staff.shiftType);
+
+  for (ScAddr const & role :
+       {StaffScheduleKeynodes::concept_cook,
+        StaffScheduleKeynodes::concept_cook,
+        StaffScheduleKeynodes::concept_waiter,
+        StaffScheduleKeynodes::concept_waiter,
+        StaffScheduleKeynodes::concept_cleaner,
+        StaffScheduleKeynodes::concept_admin})
+    AddEmployeeToRestaurant(ctx, staff.restaurant, CreateEmployee(ctx, role, staff.shiftType));
+  return staff;
+}
+
+ScAddr BuildSchedule(ScMemoryContext & ctx, ScAddr const & restaurant)
+{
+  ScAction action = ctx.GenerateAction(StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant);
+  if (!action.InitiateAndWait() || !action.IsFinishedSuccessfully())
+    return ScAddr::Empty;
+
+  ScIterator3Ptr it =
+      ctx.CreateIterator3(StaffScheduleKeynodes::concept_week_schedule, ScType::ConstPermPosArc, ScType::ConstNode);
+  return it->Next() ? it->Get(2) : ScAddr::Empty;
+}
+
+bool RepairSchedule(ScMemoryContext & ctx, ScAddr const & restaurant, ScAddr const & schedule)
+{
+  ScAction action = ctx.GenerateAction(StaffScheduleKeynodes::action_repair_staff_schedule);
+  action.SetArguments(restaurant, schedule);
+  return action.InitiateAndWait() && action.IsFinishedSuccessfully();
+}
+
+//! Assignment arcs of the shift by assigned employee.
+std::map<ScAddr, ScAddr, ScAddrLessFunc> GetAssignments(ScMemoryContext & ctx, ScAddr const & shift)
+{
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> assignments;
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_assigned_employee);
+  while (it->Next())
+    assignments.emplace(it->Get(2), it->Get(1));
+  return assignments;
+}
+
+ScAddr FindAssigned(ScMemoryContext & ctx, ScAddr const & shift, ScAddr const & role)
+{
+  for (auto const & [employee, arc] : GetAssignments(ctx, shift))
+  {
+    ScIterator5Ptr it = ctx.CreateIterator5(
+        employee, ScType::ConstCommonArc, role, ScType::ConstPermPosArc, StaffScheduleKeynodes::nrel_has_role);
+    if (it->Next())
+      return employee;
+  }
+  return ScAddr::Empty;
+}
+
+void RemoveEmployeeFromRestaurant(ScMemoryContext & ctx, ScAddr const & restaurant, ScAddr const & employee)
+{
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      restaurant,
+      ScType::ConstCommonArc,
+      employee,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_has_employee);
+  while (it->Next())
+    ctx.EraseElement(it->Get(1));
+}
+
+std::string GetAllShiftsStaffed(ScMemoryContext & ctx, ScAddr const & schedule)
+{
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      schedule,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_all_shifts_staffed);
+  std::string value;
+  if (!it->Next() || !ctx.GetLinkContent(it->Get(2), value))
+    return "";
+  return value;
+}
+}  // namespace
+
+TEST_F(RepairAgentTest, RepairStaffScheduleAgentReplacesRemovedEmployee)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<RepairStaffScheduleAgent>();
+
+  Staff const staff = CreateStaff(*m_ctx);
+  ScAddr const schedule = BuildSchedule(*m_ctx, staff.restaurant);
+  ASSERT_TRUE(m_ctx->IsElement(schedule));
+
+  ScAddr const cook = FindAssigned(*m_ctx, staff.shift, StaffScheduleKeynodes::concept_cook);
+  ASSERT_TRUE(m_ctx->IsElement(cook));
+  auto before = GetAssignments(*m_ctx, staff.shift);
+  ASSERT_EQ(before.size(), 5u);
+
+  RemoveEmployeeFromRestaurant(*m_ctx, staff.restaurant, cook);
+  EXPECT_TRUE(RepairSchedule(*m_ctx, staff.restaurant, schedule));
+
+  auto const after = GetAssignments(*m_ctx, staff.shift);
+  EXPECT_EQ(after.size(), 5u);
+  EXPECT_EQ(after.count(cook), 0u);
+
+  ScAddr const spareCook = FindAssigned(*m_ctx, staff.shift, StaffScheduleKeynodes::concept_cook);
+  EXPECT_TRUE(m_ctx->IsElement(spareCook));
+  EXPECT_NE(spareCook, cook);
+
+  // Назначения остальных сотрудников остаются теми же дугами.
+  before.erase(cook);
+  for (auto const & [employee, arc] : before)
+  {
+    auto const it = after.find(employee);
+    ASSERT_NE(it, after.end());
+    EXPECT_EQ(it->second, arc);
+  }
+
+  ScIterator5Ptr itReserve = m_ctx->CreateIterator5(
+      staff.shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_reserve_employee);
+  while (itReserve->Next())
+  {
+    EXPECT_NE(itReserve->Get(2), cook);
+    EXPECT_NE(itReserve->Get(2), spareCook);
+  }
+
+  EXPECT_EQ(GetAllShiftsStaffed(*m_ctx, schedule), "true");
+
+  m_ctx->UnsubscribeAgent<RepairStaffScheduleAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(RepairAgentTest, RepairStaffScheduleAgentDropsRemovedReserve)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<RepairStaffScheduleAgent>();
+
+  Staff const staff = CreateStaff(*m_ctx);
+  ScAddr const schedule = BuildSchedule(*m_ctx, staff.restaurant);
+  ASSERT_TRUE(m_ctx->IsElement(schedule));
+
+  ScIterator5Ptr itReserve = m_ctx->CreateIterator5(
+      staff.shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_reserve_employee);
+  ASSERT_TRUE(itReserve->Next());
+  ScAddr const reserve = itReserve->Get(2);
+
+  // Вместе с резервом из графика уходят расписание и счётчик смен сотрудника.
+  RemoveEmployeeFromRestaurant(*m_ctx, staff.restaurant, reserve);
+  EXPECT_TRUE(RepairSchedule(*m_ctx, staff.restaurant, schedule));
+
+  for (ScAddr const & relation :
+       {StaffScheduleKeynodes::nrel_employee_schedule, StaffScheduleKeynodes::nrel_shift_count})
+  {
+    ScIterator5Ptr itOwn = m_ctx->CreateIterator5(
+        reserve, ScType::ConstCommonArc, ScType::Unknown, ScType::ConstPermPosArc, relation);
+    EXPECT_FALSE(itOwn->Next());
+  }
+  ScIterator5Ptr itAfter = m_ctx->CreateIterator5(
+      staff.shift,
+      ScType::ConstCommonArc,
+      reserve,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_reserve_employee);
+  EXPECT_FALSE(itAfter->Next());
+  EXPECT_EQ(GetAssignments(*m_ctx, staff.shift).size(), 5u);
+
+  m_ctx->UnsubscribeAgent<RepairStaffScheduleAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(RepairAgentTest, RepairStaffScheduleAgentStaffsNewShift)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<RepairStaffScheduleAgent>();
+
+  Staff const staff = CreateStaff(*m_ctx);
+  ScAddr const schedule = BuildSchedule(*m_ctx, staff.restaurant);
+  ASSERT_TRUE(m_ctx->IsElement(schedule));
+  auto const before = GetAssignments(*m_ctx, staff.shift);
+
+  ScAddr const newShift = CreateShift(*m_ctx, staff.shiftType);
+  EXPECT_TRUE(RepairSchedule(*m_ctx, staff.restaurant, schedule));
+
+  EXPECT_EQ(GetAssignments(*m_ctx, staff.shift), before);
+  EXPECT_EQ(GetAssignments(*m_ctx, newShift).size(), 5u);
+  EXPECT_TRUE(m_ctx->CheckConnector(schedule, newShift, ScType::ConstPermPosArc));
+  EXPECT_EQ(GetAllShiftsStaffed(*m_ctx, schedule), "true");
+
+  m_ctx->UnsubscribeAgent<RepairStaffScheduleAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+TEST_F(RepairAgentTest, RepairStaffScheduleAgentNeedsSchedule)
+{
+  m_ctx->SubscribeAgent<RepairStaffScheduleAgent>();
+
+  Staff const staff = CreateStaff(*m_ctx);
+  EXPECT_FALSE(RepairSchedule(*m_ctx, staff.restaurant, staff.shift));
+
+  m_ctx->UnsubscribeAgent<RepairStaffScheduleAgent>();
+}
+
+TEST_F(RepairAgentTest, RepairStaffScheduleAgentKeepsSolverOfSchedule)
+{
+  m_ctx->SubscribeAgent<BuildStaffScheduleAgent>();
+  m_ctx->SubscribeAgent<RepairStaffScheduleAgent>();
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr shiftType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, shiftType);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+
+  // Вместо ушедшего повара решатель предпочтений берёт того из двух свободных, кто предпочитает эту смену.
+  std::vector<ScAddr> cooks;
+  for (bool const prefers : {true, false, true})
+  {
+    ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, shiftType);
+    if (prefers)
+      AddPreferredShiftType(*m_ctx, cook, shiftType, "3");
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+    cooks.push_back(cook);
+  }
+
+  ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant, StaffScheduleKeynodes::concept_solver_preference);
+  ASSERT_TRUE(action.InitiateAndWait());
+  ASSERT_TRUE(action.IsFinishedSuccessfully());
+  ScIterator5Ptr itCurrent = m_ctx->CreateIterator5(
+      restaurant,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_current_schedule);
+  ASSERT_TRUE(itCurrent->Next());
+  ScAddr const schedule = itCurrent->Get(2);
+
+  auto const assigned = GetAssignments(*m_ctx, shift);
+  ASSERT_EQ(assigned.size(), 1u);
+  ScAddr const leaving = assigned.begin()->first;
+  ASSERT_NE(leaving, cooks[1]);
+
+  RemoveEmployeeFromRestaurant(*m_ctx, restaurant, leaving);
+  EXPECT_TRUE(RepairSchedule(*m_ctx, restaurant, schedule));
+
+  auto const after = GetAssignments(*m_ctx, shift);
+  ASSERT_EQ(after.size(), 1u);
+  EXPECT_EQ(after.begin()->first, leaving == cooks[0] ? cooks[2] : cooks[0]);
+
+  ScIterator5Ptr itSolver = m_ctx->CreateIterator5(
+      schedule,
+      ScType::ConstCommonArc,
+      StaffScheduleKeynodes::concept_solver_preference,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_schedule_solver);
+  EXPECT_TRUE(itSolver->Next());
+
+  m_ctx->UnsubscribeAgent<RepairStaffScheduleAgent>();
+  m_ctx->UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
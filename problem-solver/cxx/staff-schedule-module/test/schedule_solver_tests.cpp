@@ -0,0 +1,367 @@
+#include <gtest/gtest.h>
+
+#include "solver/decomposed_max_flow.hpp"
+#include "solver/flow_network.hpp"
+#include "solver/min_cost_max_flow.hpp"
+#include "solver/run_on_new_threads.hpp"
+#include "solver/schedule_solver.hpp"
+#include "solver/weighted_max_flow.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+struct TestNetwork
+{
+  FlowNetwork network;
+  size_t source = 0;
+  size_t sink = 0;
+};
+
+// Сеть той же формы, что строит StaffScheduleBuilder: сотрудники, потребности смен, единичные дуги между ними.
+TestNetwork GenerateScheduleNetwork(std::mt19937 & random, size_t leftCount, size_t rightCount)
+{
+  TestNetwork result;
+  result.source = leftCount + rightCount;
+  result.sink = result.source + 1;
+  result.network.Reset(result.sink + 1);
+
+  for (size_t left = 0; left < leftCount; ++left)
+    result.network.AddEdge(result.source, left, static_cast<int>(1 + random() % 5));
+  for (size_t left = 0; left < leftCount; ++left)
+  {
+    for (size_t right = 0; right < rightCount; ++right)
+    {
+      if (random() % 3 == 0)
+        result.network.AddEdge(left, leftCount + right, 1);
+    }
+  }
+  for (size_t right = 0; right < rightCount; ++right)
+    result.network.AddEdge(leftCount + right, result.sink, static_cast<int>(1 + random() % 3));
+
+  result.network.Build();
+  return result;
+}
+
+// Проверяет ограничения по ёмкости и сохранение потока во всех вершинах, кроме истока и стока.
+void ExpectValidFlow(TestNetwork const & test, int flow)
+{
+  FlowNetwork const & network = test.network;
+  std::vector<int> balance(network.GetNodeCount(), 0);
+  for (size_t edge = 0; edge < network.GetEdgeCount(); ++edge)
+  {
+    FlowNetwork::Arc const & forward = network.GetArc(network.GetEdgeArc(edge));
+    int const edgeFlow = network.GetEdgeFlow(edge);
+    EXPECT_GE(edgeFlow, 0);
+    EXPECT_GE(forward.cap, 0);
+
+    size_t const from = static_cast<size_t>(network.GetArc(static_cast<size_t>(forward.rev)).to);
+    balance[from] -= edgeFlow;
+    balance[static_cast<size_t>(forward.to)] += edgeFlow;
+  }
+
+  for (size_t node = 0; node < network.GetNodeCount(); ++node)
+  {
+    if (node == test.source)
+      EXPECT_EQ(balance[node], -flow);
+    else if (node == test.sink)
+      EXPECT_EQ(balance[node], flow);
+    else
+      EXPECT_EQ(balance[node], 0);
+  }
+}
+
+struct CostEdge
+{
+  size_t from;
+  size_t to;
+  int cap;
+  int cost;
+};
+
+// Эталон: кратчайшие пути Беллмана — Форда по одной единице потока, возвращает стоимость максимального потока.
+size_t FindMinCost(TestNetwork const & test, std::vector<CostEdge> const & costEdges)
+{
+  struct Edge
+  {
+    size_t to;
+    int cap;
+    int cost;
+  };
+  std::vector<Edge> edges;
+  std::vector<std::vector<size_t>> arcs(test.network.GetNodeCount());
+  for (auto const & edge : costEdges)
+  {
+    arcs[edge.from].push_back(edges.size());
+    edges.push_back({edge.to, edge.cap, edge.cost});
+    arcs[edge.to].push_back(edges.size());
+    edges.push_back({edge.from, 0, -edge.cost});
+  }
+
+  size_t cost = 0;
+  while (true)
+  {
+    std::vector<int> distance(arcs.size(), std::numeric_limits<int>::max());
+    std::vector<size_t> previous(arcs.size(), edges.size());
+    distance[test.source] = 0;
+    for (bool changed = true; changed;)
+    {
+      changed = false;
+      for (size_t node = 0; node < arcs.size(); ++node)
+      {
+        if (distance[node] == std::numeric_limits<int>::max())
+          continue;
+        for (size_t e : arcs[node])
+        {
+          if (edges[e].cap > 0 && distance[node] + edges[e].cost < distance[edges[e].to])
+          {
+            distance[edges[e].to] = distance[node] + edges[e].cost;
+            previous[edges[e].to] = e;
+            changed = true;
+          }
+        }
+      }
+    }
+    if (distance[test.sink] == std::numeric_limits<int>::max())
+      return cost;
+
+    for (size_t node = test.sink; node != test.source; node = edges[previous[node] ^ 1].to)
+    {
+      edges[previous[node]].cap -= 1;
+      edges[previous[node] ^ 1].cap += 1;
+    }
+    cost += static_cast<size_t>(distance[test.sink]);
+  }
+}
+
+// Единичные дуги из истока со стоимостями 1, 3, 5, ..., остальные дуги бесплатны.
+size_t FindMinSquaredLoad(TestNetwork const & test)
+{
+  std::vector<CostEdge> edges;
+  for (size_t edge = 0; edge < test.network.GetEdgeCount(); ++edge)
+  {
+    FlowNetwork::Arc const & forward = test.network.GetArc(test.network.GetEdgeArc(edge));
+    size_t const from = static_cast<size_t>(test.network.GetArc(static_cast<size_t>(forward.rev)).to);
+    if (from != test.source)
+    {
+      edges.push_back({from, static_cast<size_t>(forward.to), forward.cap, 0});
+      continue;
+    }
+    for (int unit = 0; unit < forward.cap; ++unit)
+      edges.push_back({from, static_cast<size_t>(forward.to), 1, 2 * unit + 1});
+  }
+  return FindMinCost(test, edges);
+}
+
+// Каждая дуга сети со своей стоимостью за единицу потока.
+size_t FindMinEdgeCost(TestNetwork const & test, std::vector<int> const & edgeCosts)
+{
+  std::vector<CostEdge> edges;
+  for (size_t edge = 0; edge < test.network.GetEdgeCount(); ++edge)
+  {
+    FlowNetwork::Arc const & forward = test.network.GetArc(test.network.GetEdgeArc(edge));
+    size_t const from = static_cast<size_t>(test.network.GetArc(static_cast<size_t>(forward.rev)).to);
+    edges.push_back({from, static_cast<size_t>(forward.to), forward.cap, edgeCosts[edge]});
+  }
+  return FindMinCost(test, edges);
+}
+}  // namespace
+
+TEST(ScheduleSolverTest, SolversFindSameFlow)
+{
+  std::mt19937 random(7);
+  for (size_t round = 0; round < 50; ++round)
+  {
+    TestNetwork const test = GenerateScheduleNetwork(random, 1 + random() % 40, 1 + random() % 40);
+
+    TestNetwork dinic = test;
+    int const expected = CreateScheduleSolver(ScheduleSolverType::Dinic)->Solve(dinic.network, dinic.source, dinic.sink);
+    ExpectValidFlow(dinic, expected);
+
+    for (ScheduleSolverType type :
+         {ScheduleSolverType::HopcroftKarp,
+          ScheduleSolverType::PushRelabel,
+          ScheduleSolverType::Decomposed,
+          ScheduleSolverType::MinCost,
+          ScheduleSolverType::Preference})
+    {
+      TestNetwork solved = test;
+      int const flow = CreateScheduleSolver(type)->Solve(solved.network, solved.source, solved.sink);
+      EXPECT_EQ(flow, expected);
+      ExpectValidFlow(solved, flow);
+    }
+  }
+}
+
+TEST(ScheduleSolverTest, DecomposedSolverFindsMaxFlowOfLabeledParts)
+{
+  std::mt19937 random(11);
+  for (size_t round = 0; round < 50; ++round)
+  {
+    size_t const leftCount = 1 + random() % 40;
+    size_t const rightCount = 1 + random() % 40;
+    TestNetwork const test = GenerateScheduleNetwork(random, leftCount, rightCount);
+
+    // Метки правых вершин играют роль дней смен, сотрудники связывают части между собой.
+    std::vector<size_t> nodeParts(test.network.GetNodeCount(), 0);
+    for (size_t right = 0; right < rightCount; ++right)
+      nodeParts[leftCount + right] = 1 + random() % 7;
+
+    TestNetwork dinic = test;
+    int const expected =
+        CreateScheduleSolver(ScheduleSolverType::Dinic)->Solve(dinic.network, dinic.source, dinic.sink);
+
+    TestNetwork solved = test;
+    DecomposedMaxFlow solver(nodeParts);
+    int const flow = solver.Solve(solved.network, solved.source, solved.sink);
+    EXPECT_EQ(flow, expected);
+    ExpectValidFlow(solved, flow);
+
+    auto const counters = solver.GetCounters();
+    auto const parts = std::find_if(counters.begin(), counters.end(), [](auto const & counter) {
+      return counter.first == "parts";
+    });
+    ASSERT_NE(parts, counters.end());
+    EXPECT_GE(parts->second, 1u);
+  }
+}
+
+TEST(ScheduleSolverTest, DecomposedSolverReroutesExistingFlow)
+{
+  // Сотрудник 0 (лимит 1) уже стоит на потребности 2, сотрудник 1 может взять только её,
+  // а сотрудник 0 может перейти на потребность 3.
+  TestNetwork test;
+  test.source = 4;
+  test.sink = 5;
+  test.network.Reset(6);
+  test.network.AddEdge(test.source, 0, 1);
+  test.network.AddEdge(test.source, 1, 1);
+  test.network.AddEdge(0, 2, 1);
+  test.network.AddEdge(0, 3, 1);
+  test.network.AddEdge(1, 2, 1);
+  test.network.AddEdge(2, test.sink, 1);
+  test.network.AddEdge(3, test.sink, 1);
+  test.network.Build();
+  for (size_t edge : {0u, 2u, 5u})
+    test.network.Push(test.network.GetEdgeArc(edge), 1);
+
+  DecomposedMaxFlow solver;
+  EXPECT_EQ(solver.Solve(test.network, test.source, test.sink), 1);
+  ExpectValidFlow(test, 2);
+}
+
+TEST(ScheduleSolverTest, NestedRunOnNewThreadsUsesCallingThread)
+{
+  std::vector<size_t> innerThreads(4, 0);
+  RunOnNewThreads(innerThreads.size(), [&](size_t i) {
+    innerThreads[i] = RunOnNewThreads(8, [](size_t) {});
+  });
+  for (size_t threads : innerThreads)
+    EXPECT_EQ(threads, 1u);
+  EXPECT_EQ(RunOnNewThreads(0, [](size_t) {}), 0u);
+}
+
+TEST(ScheduleSolverTest, MinCostSolverFindsMostEvenLoad)
+{
+  std::mt19937 random(13);
+  for (size_t round = 0; round < 30; ++round)
+  {
+    TestNetwork const test = GenerateScheduleNetwork(random, 1 + random() % 12, 1 + random() % 12);
+
+    TestNetwork solved = test;
+    MinCostMaxFlow solver;
+    int const flow = solver.Solve(solved.network, solved.source, solved.sink);
+    ExpectValidFlow(solved, flow);
+    EXPECT_EQ(solver.GetCost(), FindMinSquaredLoad(test));
+  }
+}
+
+TEST(ScheduleSolverTest, WeightedSolverFindsCheapestMaxFlow)
+{
+  std::mt19937 random(17);
+  for (size_t round = 0; round < 30; ++round)
+  {
+    TestNetwork const test = GenerateScheduleNetwork(random, 1 + random() % 12, 1 + random() % 12);
+
+    // Стоимости только у дуг между долями, как у назначений с предпочтениями.
+    std::vector<int> edgeCosts(test.network.GetEdgeCount(), 0);
+    for (size_t edge = 0; edge < edgeCosts.size(); ++edge)
+    {
+      FlowNetwork::Arc const & forward = test.network.GetArc(test.network.GetEdgeArc(edge));
+      size_t const from = static_cast<size_t>(test.network.GetArc(static_cast<size_t>(forward.rev)).to);
+      if (from != test.source && static_cast<size_t>(forward.to) != test.sink)
+        edgeCosts[edge] = static_cast<int>(random() % 4);
+    }
+
+    TestNetwork dinic = test;
+    int const expected =
+        CreateScheduleSolver(ScheduleSolverType::Dinic)->Solve(dinic.network, dinic.source, dinic.sink);
+
+    std::vector<int> arcCosts(2 * edgeCosts.size(), 0);
+    for (size_t edge = 0; edge < edgeCosts.size(); ++edge)
+    {
+      size_t const arc = test.network.GetEdgeArc(edge);
+      arcCosts[arc] = edgeCosts[edge];
+      arcCosts[static_cast<size_t>(test.network.GetArc(arc).rev)] = -edgeCosts[edge];
+    }
+
+    TestNetwork solved = test;
+    WeightedMaxFlow solver(arcCosts);
+    int const flow = solver.Solve(solved.network, solved.source, solved.sink);
+    EXPECT_EQ(flow, expected);
+    ExpectValidFlow(solved, flow);
+    EXPECT_EQ(solver.GetCost(), FindMinEdgeCost(test, edgeCosts));
+  }
+}
+
+TEST(ScheduleSolverTest, MinCostSolverSpreadsShiftsBetweenEmployees)
+{
+  // Оба сотрудника могут работать в обеих сменах; Dinic может отдать обе смены первому.
+  TestNetwork test;
+  test.source = 4;
+  test.sink = 5;
+  test.network.Reset(6);
+  test.network.AddEdge(test.source, 0, 5);
+  test.network.AddEdge(test.source, 1, 5);
+  for (size_t employee : {0, 1})
+  {
+    for (size_t shift : {2, 3})
+      test.network.AddEdge(employee, shift, 1);
+  }
+  test.network.AddEdge(2, test.sink, 1);
+  test.network.AddEdge(3, test.sink, 1);
+  test.network.Build();
+
+  MinCostMaxFlow solver;
+  int const flow = solver.Solve(test.network, test.source, test.sink);
+
+  EXPECT_EQ(flow, 2);
+  EXPECT_EQ(solver.GetCost(), 2u);
+  ExpectValidFlow(test, flow);
+}
+
+TEST(ScheduleSolverTest, BipartiteSolversFallBackOnOtherNetworks)
+{
+  // Исток -> 0 -> 1 -> сток и исток -> 1: вершина 1 не принадлежит одной доле.
+  TestNetwork test;
+  test.source = 2;
+  test.sink = 3;
+  test.network.Reset(4);
+  test.network.AddEdge(test.source, 0, 2);
+  test.network.AddEdge(test.source, 1, 1);
+  test.network.AddEdge(0, 1, 2);
+  test.network.AddEdge(1, test.sink, 2);
+  test.network.Build();
+
+  for (ScheduleSolverType type : {ScheduleSolverType::HopcroftKarp, ScheduleSolverType::Decomposed})
+  {
+    TestNetwork solved = test;
+    int const flow = CreateScheduleSolver(type)->Solve(solved.network, solved.source, solved.sink);
+
+    EXPECT_EQ(flow, 2);
+    ExpectValidFlow(solved, flow);
+  }
+}
@@ -0,0 +1,90 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "cache/staff_data_cache.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <memory>
+
+using StaffDataCacheTest = ScMemoryTest;
+
+TEST_F(StaffDataCacheTest, ChangesOfStaffRelationsInvalidateCache)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayType);
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+
+  StaffDataCache cache;
+  auto data = std::make_shared<StaffData const>();
+
+  // Без подписки кэш ничего не хранит.
+  cache.Store(restaurant, cache.GetVersion(), data);
+  EXPECT_EQ(cache.Find(restaurant), nullptr);
+
+  cache.Subscribe();
+  cache.Store(restaurant, cache.GetVersion(), data);
+  EXPECT_EQ(cache.Find(restaurant), data);
+
+  // Записи расписания не относятся к данным персонала и кэш не сбрасывают.
+  AddRelation(*m_ctx, shift, cook, StaffScheduleKeynodes::nrel_assigned_employee);
+  AddRelation(*m_ctx, cook, shift, StaffScheduleKeynodes::nrel_can_work);
+  EXPECT_EQ(cache.Find(restaurant), data);
+
+  AddRelation(*m_ctx, cook, dayType, StaffScheduleKeynodes::nrel_available_shift_type);
+  EXPECT_EQ(cache.Find(restaurant), nullptr);
+
+  // Данные, прочитанные до изменения, не сохраняются.
+  size_t const version = cache.GetVersion();
+  ScAddr waiter = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, waiter);
+  cache.Store(restaurant, version, data);
+  EXPECT_EQ(cache.Find(restaurant), nullptr);
+
+  cache.Store(restaurant, cache.GetVersion(), data);
+  EXPECT_EQ(cache.Find(restaurant), data);
+  cache.Unsubscribe();
+  EXPECT_EQ(cache.Find(restaurant), nullptr);
+}
+
+TEST_F(StaffDataCacheTest, ChangesOfNumberLinksInvalidateCache)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr cook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType, "5");
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+
+  StaffDataCache cache;
+  auto data = std::make_shared<StaffData const>();
+  cache.Subscribe();
+
+  // Лимит смен записан до подписки: правка его ссылки всё равно сбрасывает кэш.
+  ScIterator5Ptr itMax = m_ctx->CreateIterator5(
+      cook,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_max_shifts_per_week);
+  ASSERT_TRUE(itMax->Next());
+  cache.Store(restaurant, cache.GetVersion(), data);
+  m_ctx->SetLinkContent(itMax->Get(2), "3");
+  EXPECT_EQ(cache.Find(restaurant), nullptr);
+
+  // Часы добавлены после подписки: их ссылка тоже отслеживается.
+  AddCount(*m_ctx, dayType, StaffScheduleKeynodes::nrel_start_hour, "8");
+  ScIterator5Ptr itStart = m_ctx->CreateIterator5(
+      dayType,
+      ScType::ConstCommonArc,
+      ScType::ConstNodeLink,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_start_hour);
+  ASSERT_TRUE(itStart->Next());
+  cache.Store(restaurant, cache.GetVersion(), data);
+  m_ctx->SetLinkContent(itStart->Get(2), "9");
+  EXPECT_EQ(cache.Find(restaurant), nullptr);
+
+  cache.Unsubscribe();
+}
@@ -0,0 +1,481 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "builder/staff_schedule_builder.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+
+using BuilderTest = ScMemoryTest;
+
+TEST_F(BuilderTest, StaffDataReadModesAgree)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr otherRestaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  ScAddr dayShift = CreateShift(*m_ctx, dayType);
+  CreateShift(*m_ctx, nightType);
+
+  ScAddr untypedShift = m_ctx->GenerateNode(ScType::ConstNode);
+  m_ctx->GenerateConnector(ScType::ConstPermPosArc, StaffScheduleKeynodes::concept_shift, untypedShift);
+  AddRelation(*m_ctx, dayShift, m_ctx->GenerateNode(ScType::ConstNode), StaffScheduleKeynodes::nrel_shift_day);
+
+  ScAddr cook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType, "3");
+  ScAddr waiter = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayType, "many");
+  AddRelation(*m_ctx, waiter, nightType, StaffScheduleKeynodes::nrel_available_shift_type);
+  AddPreferredShiftType(*m_ctx, waiter, nightType, "3");
+  AddPreferredShiftType(*m_ctx, waiter, dayType);
+
+  // Сотрудник без доступных типов смен доступен для всех, сотрудник без роли пропускается.
+  ScAddr cleaner = m_ctx->GenerateNode(ScType::ConstNode);
+  AddRelation(*m_ctx, cleaner, StaffScheduleKeynodes::concept_cleaner, StaffScheduleKeynodes::nrel_has_role);
+  ScAddr withoutRole = m_ctx->GenerateNode(ScType::ConstNode);
+
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, waiter);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cleaner);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, withoutRole);
+  AddEmployeeToRestaurant(
+      *m_ctx, otherRestaurant, CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_admin, dayType));
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder perEntity(*m_ctx, logger);
+  perEntity.ReadStaffData(restaurant, StaffDataReadMode::PerEntity);
+  StaffScheduleBuilder byRelations(*m_ctx, logger);
+  byRelations.ReadStaffData(restaurant, StaffDataReadMode::RelationScan);
+
+  auto const & expectedEmployees = perEntity.GetEmployees();
+  auto const & employees = byRelations.GetEmployees();
+  ASSERT_EQ(expectedEmployees.size(), 3u);
+  ASSERT_EQ(employees.size(), expectedEmployees.size());
+  for (size_t i = 0; i < employees.size(); ++i)
+  {
+    EXPECT_EQ(employees[i].addr, expectedEmployees[i].addr);
+    EXPECT_EQ(employees[i].role, expectedEmployees[i].role);
+    EXPECT_EQ(employees[i].roleIndex, expectedEmployees[i].roleIndex);
+    EXPECT_EQ(employees[i].maxShifts, expectedEmployees[i].maxShifts);
+    EXPECT_EQ(employees[i].availableShiftTypes.size(), expectedEmployees[i].availableShiftTypes.size());
+    ASSERT_EQ(employees[i].preferredShiftTypes.size(), expectedEmployees[i].preferredShiftTypes.size());
+    for (size_t k = 0; k < employees[i].preferredShiftTypes.size(); ++k)
+      EXPECT_EQ(employees[i].preferredShiftTypes[k].weight, expectedEmployees[i].preferredShiftTypes[k].weight);
+  }
+  EXPECT_EQ(employees[0].maxShifts, 3u);
+  EXPECT_EQ(employees[1].maxShifts, 5u);
+  EXPECT_EQ(employees[2].availableShiftTypes.size(), 2u);
+
+  auto const & expectedShifts = perEntity.GetShifts();
+  auto const & shifts = byRelations.GetShifts();
+  ASSERT_EQ(expectedShifts.size(), 2u);
+  ASSERT_EQ(shifts.size(), expectedShifts.size());
+  for (size_t j = 0; j < shifts.size(); ++j)
+  {
+    EXPECT_EQ(shifts[j].addr, expectedShifts[j].addr);
+    EXPECT_EQ(shifts[j].shiftType, expectedShifts[j].shiftType);
+    EXPECT_EQ(shifts[j].shiftTypeIndex, expectedShifts[j].shiftTypeIndex);
+    EXPECT_EQ(shifts[j].day, expectedShifts[j].day);
+  }
+}
+
+TEST_F(BuilderTest, ShiftsAreReadForTheirRestaurant)
+{
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr otherRestaurant = CreateRestaurant(*m_ctx);
+  ScAddr unscopedRestaurant = CreateRestaurant(*m_ctx);
+
+  ScAddr ownShift = CreateShift(*m_ctx, dayType);
+  AddShiftToRestaurant(*m_ctx, restaurant, ownShift);
+  AddShiftToRestaurant(*m_ctx, otherRestaurant, CreateShift(*m_ctx, dayType));
+  ScAddr freeShift = CreateShift(*m_ctx, dayType);
+
+  utils::ScLogger logger;
+  for (StaffDataReadMode mode : {StaffDataReadMode::PerEntity, StaffDataReadMode::RelationScan})
+  {
+    StaffScheduleBuilder scoped(*m_ctx, logger);
+    scoped.ReadStaffData(restaurant, mode);
+    ASSERT_EQ(scoped.GetShifts().size(), 1u);
+    EXPECT_EQ(scoped.GetShifts()[0].addr, ownShift);
+
+    // Ресторан без nrel_has_shift получает только смены, не принадлежащие другим ресторанам.
+    StaffScheduleBuilder unscoped(*m_ctx, logger);
+    unscoped.ReadStaffData(unscopedRestaurant, mode);
+    ASSERT_EQ(unscoped.GetShifts().size(), 1u);
+    EXPECT_EQ(unscoped.GetShifts()[0].addr, freeShift);
+  }
+}
+
+TEST_F(BuilderTest, RequirementsOfShiftReplaceThoseOfTypeAndRestaurant)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  ScAddr dayShift = CreateShift(*m_ctx, dayType);
+  ScAddr nightShift = CreateShift(*m_ctx, nightType);
+  ScAddr fridayNight = CreateShift(*m_ctx, nightType);
+  for (ScAddr const & shift : {dayShift, nightShift, fridayNight})
+    AddShiftToRestaurant(*m_ctx, restaurant, shift);
+
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_waiter, "2");
+  AddStaffingRequirement(*m_ctx, nightType, StaffScheduleKeynodes::concept_cook, "0");
+  AddStaffingRequirement(*m_ctx, nightType, StaffScheduleKeynodes::concept_waiter, "3");
+  AddStaffingRequirement(*m_ctx, fridayNight, StaffScheduleKeynodes::concept_waiter, "4");
+  AddStaffingRequirement(*m_ctx, fridayNight, StaffScheduleKeynodes::concept_admin, "many");
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+
+  auto const findCount = [&](ScAddr const & shiftAddr, ScAddr const & role) -> int {
+    for (auto const & shift : builder.GetShifts())
+    {
+      if (shift.addr != shiftAddr)
+        continue;
+      for (auto const & requirement : shift.requirements)
+      {
+        if (requirement.role == role)
+          return static_cast<int>(requirement.count);
+      }
+    }
+    return -1;
+  };
+
+  EXPECT_EQ(findCount(dayShift, StaffScheduleKeynodes::concept_cook), 1);
+  EXPECT_EQ(findCount(dayShift, StaffScheduleKeynodes::concept_waiter), 2);
+  EXPECT_EQ(findCount(nightShift, StaffScheduleKeynodes::concept_cook), 0);
+  EXPECT_EQ(findCount(nightShift, StaffScheduleKeynodes::concept_waiter), 3);
+  EXPECT_EQ(findCount(fridayNight, StaffScheduleKeynodes::concept_waiter), 4);
+  // Требование с неверным числом пропускается, роль без требований не добавляется.
+  EXPECT_EQ(findCount(fridayNight, StaffScheduleKeynodes::concept_admin), -1);
+  EXPECT_EQ(findCount(dayShift, StaffScheduleKeynodes::concept_cleaner), -1);
+
+  // Каждая потребность — одна вершина с ёмкостью, число слотов равно сумме требований.
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.GetSlotCount(), 3u + 3u + 4u);
+}
+
+TEST_F(BuilderTest, ReservesAreRankedByShiftsLeft)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayType);
+  AddShiftToRestaurant(*m_ctx, restaurant, shift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+
+  ScAddr reserveCount = m_ctx->GenerateLink();
+  m_ctx->SetLinkContent(reserveCount, "2");
+  AddRelation(*m_ctx, restaurant, reserveCount, StaffScheduleKeynodes::nrel_reserve_count);
+
+  // Сотрудник с нулевым лимитом не назначается и в резерв не попадает.
+  std::map<ScAddr, size_t, ScAddrLessFunc> maxShifts;
+  for (char const * max : {"1", "3", "4", "2", "0"})
+  {
+    ScAddr cook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType, max);
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+    maxShifts[cook] = std::stoul(max);
+  }
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.FindMaxFlow(), 1u);
+  builder.WriteSchedule();
+
+  ScIterator5Ptr itAssigned = m_ctx->CreateIterator5(
+      shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_assigned_employee);
+  ASSERT_TRUE(itAssigned->Next());
+  maxShifts.erase(itAssigned->Get(2));
+
+  // Остальные не назначены, их запас равен лимиту: в резерв идут двое с наибольшим ненулевым лимитом.
+  std::set<size_t> reserveMax;
+  ScIterator5Ptr itReserve = m_ctx->CreateIterator5(
+      shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_reserve_employee);
+  while (itReserve->Next())
+  {
+    auto const it = maxShifts.find(itReserve->Get(2));
+    ASSERT_NE(it, maxShifts.end());
+    reserveMax.insert(it->second);
+  }
+
+  std::set<size_t> expectedMax;
+  for (auto const & [cook, max] : maxShifts)
+    expectedMax.insert(max);
+  expectedMax.erase(0);
+  expectedMax.erase(expectedMax.begin());
+  EXPECT_EQ(reserveMax, expectedMax);
+  EXPECT_NE(builder.GetMetrics().ToJson().find("\"reserves\":2"), std::string::npos);
+}
+
+TEST_F(BuilderTest, SubstituteSearchKeepsWriteScheduleMetrics)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayType);
+  AddShiftToRestaurant(*m_ctx, restaurant, shift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_reserve_count, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_substitute_count, "1");
+  AddEmployeeToRestaurant(*m_ctx, restaurant, CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType));
+  AddEmployeeToRestaurant(*m_ctx, restaurant, CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayType));
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.FindMaxFlow(), 1u);
+  builder.WriteSchedule();
+
+  // Поиск замен открывает вложенную стадию, после неё счётчики снова идут в запись графика.
+  std::map<std::string, size_t> counters;
+  size_t writtenElements = 0;
+  bool pathsFound = false;
+  for (auto const & phase : builder.GetMetrics().GetPhases())
+  {
+    pathsFound |= phase.name == "alternating_paths";
+    if (phase.name != "write_schedule")
+      continue;
+    writtenElements = phase.elementsCreated;
+    counters.insert(phase.counters.begin(), phase.counters.end());
+  }
+  EXPECT_TRUE(pathsFound);
+  EXPECT_GT(writtenElements, 0u);
+  EXPECT_EQ(counters["reserves"], 1u);
+  EXPECT_EQ(counters["substitutes"], 1u);
+}
+
+TEST_F(BuilderTest, DailyLimitAddsDayNodesOnlyWhereNeeded)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr morningType = CreateShiftType(*m_ctx);
+  ScAddr eveningType = CreateShiftType(*m_ctx);
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> shiftDays;
+  for (size_t k = 0; k < 2; ++k)
+  {
+    ScAddr day = m_ctx->GenerateNode(ScType::ConstNode);
+    for (ScAddr const & shiftType : {morningType, eveningType})
+    {
+      ScAddr shift = CreateShift(*m_ctx, shiftType);
+      AddRelation(*m_ctx, shift, day, StaffScheduleKeynodes::nrel_shift_day);
+      AddShiftToRestaurant(*m_ctx, restaurant, shift);
+      shiftDays[shift] = day;
+    }
+  }
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "2");
+
+  // Вершины дней нужны только повару, у которого в день две смены-кандидата.
+  ScAddr anyCook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType);
+  AddRelation(*m_ctx, anyCook, eveningType, StaffScheduleKeynodes::nrel_available_shift_type);
+  ScAddr morningCook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, anyCook);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, morningCook);
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder unlimited(*m_ctx, logger);
+  unlimited.ReadStaffData(restaurant);
+  unlimited.BuildFlowNetwork();
+  EXPECT_EQ(unlimited.GetNetwork().GetNodeCount(), 2u + 4u + 2u);
+  EXPECT_EQ(unlimited.FindMaxFlow(), 6u);
+
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_max_shifts_per_day, "1");
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.GetNetwork().GetNodeCount(), 2u + 4u + 2u + 2u);
+  EXPECT_EQ(builder.FindMaxFlow(), 4u);
+  builder.WriteSchedule();
+
+  for (auto const & employee : builder.GetEmployees())
+  {
+    std::set<ScAddr, ScAddrLessFunc> days;
+    for (ScAddr const & shift : employee.assignedShifts)
+      EXPECT_TRUE(days.insert(shiftDays.at(shift)).second);
+    EXPECT_EQ(days.size(), 2u);
+  }
+}
+
+TEST_F(BuilderTest, MinimumRestDropsShiftsTooCloseToEachOther)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr morningType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  AddCount(*m_ctx, morningType, StaffScheduleKeynodes::nrel_start_hour, "6");
+  AddCount(*m_ctx, morningType, StaffScheduleKeynodes::nrel_end_hour, "14");
+  AddCount(*m_ctx, nightType, StaffScheduleKeynodes::nrel_start_hour, "22");
+  AddCount(*m_ctx, nightType, StaffScheduleKeynodes::nrel_end_hour, "6");
+
+  ScAddr monday = m_ctx->GenerateNode(ScType::ConstNode);
+  ScAddr tuesday = m_ctx->GenerateNode(ScType::ConstNode);
+  AddRelation(*m_ctx, monday, tuesday, StaffScheduleKeynodes::nrel_next_day);
+  ScAddr mondayNight = CreateShift(*m_ctx, nightType);
+  AddRelation(*m_ctx, mondayNight, monday, StaffScheduleKeynodes::nrel_shift_day);
+  ScAddr tuesdayMorning = CreateShift(*m_ctx, morningType);
+  AddRelation(*m_ctx, tuesdayMorning, tuesday, StaffScheduleKeynodes::nrel_shift_day);
+  AddShiftToRestaurant(*m_ctx, restaurant, mondayNight);
+  AddShiftToRestaurant(*m_ctx, restaurant, tuesdayMorning);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_min_rest_hours, "11");
+
+  ScAddr anyCook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType);
+  AddRelation(*m_ctx, anyCook, nightType, StaffScheduleKeynodes::nrel_available_shift_type);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, anyCook);
+
+  // Ночная смена заканчивается в 6 утра вторника, утренняя тут же начинается: одну из них снимаем.
+  utils::ScLogger logger;
+  StaffScheduleBuilder alone(*m_ctx, logger);
+  alone.ReadStaffData(restaurant);
+  alone.BuildFlowNetwork();
+  EXPECT_EQ(alone.FindMaxFlow(), 1u);
+  EXPECT_NE(alone.GetMetrics().ToJson().find("\"rest_conflicts\":1"), std::string::npos);
+
+  // Со вторым поваром снятая смена достаётся ему, и график снова полный.
+  ScAddr morningCook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, morningCook);
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.FindMaxFlow(), 2u);
+  builder.WriteSchedule();
+  for (auto const & employee : builder.GetEmployees())
+  {
+    ASSERT_EQ(employee.assignedShifts.size(), 1u);
+    EXPECT_EQ(employee.assignedShifts[0], employee.addr == anyCook ? mondayNight : tuesdayMorning);
+  }
+}
+
+TEST_F(BuilderTest, MinimumRestIsKeptAcrossTheEndOfTheWeek)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr morningType = CreateShiftType(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  AddCount(*m_ctx, morningType, StaffScheduleKeynodes::nrel_start_hour, "6");
+  AddCount(*m_ctx, morningType, StaffScheduleKeynodes::nrel_end_hour, "14");
+  AddCount(*m_ctx, nightType, StaffScheduleKeynodes::nrel_start_hour, "22");
+  AddCount(*m_ctx, nightType, StaffScheduleKeynodes::nrel_end_hour, "6");
+
+  // Неделя из двух дней: ночь последнего дня переходит в утро первого.
+  ScAddr monday = m_ctx->GenerateNode(ScType::ConstNode);
+  ScAddr tuesday = m_ctx->GenerateNode(ScType::ConstNode);
+  AddRelation(*m_ctx, monday, tuesday, StaffScheduleKeynodes::nrel_next_day);
+  ScAddr weekEnd = m_ctx->GenerateConnector(ScType::ConstCommonArc, tuesday, monday);
+  m_ctx->GenerateConnector(ScType::ConstPermPosArc, StaffScheduleKeynodes::nrel_next_day, weekEnd);
+  ScAddr mondayMorning = CreateShift(*m_ctx, morningType);
+  AddRelation(*m_ctx, mondayMorning, monday, StaffScheduleKeynodes::nrel_shift_day);
+  ScAddr tuesdayNight = CreateShift(*m_ctx, nightType);
+  AddRelation(*m_ctx, tuesdayNight, tuesday, StaffScheduleKeynodes::nrel_shift_day);
+  AddShiftToRestaurant(*m_ctx, restaurant, mondayMorning);
+  AddShiftToRestaurant(*m_ctx, restaurant, tuesdayNight);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+  AddCount(*m_ctx, restaurant, StaffScheduleKeynodes::nrel_min_rest_hours, "11");
+
+  ScAddr cook = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType);
+  AddRelation(*m_ctx, cook, nightType, StaffScheduleKeynodes::nrel_available_shift_type);
+  AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder cyclic(*m_ctx, logger);
+  cyclic.ReadStaffData(restaurant);
+  cyclic.BuildFlowNetwork();
+  EXPECT_EQ(cyclic.FindMaxFlow(), 1u);
+
+  // Без замыкания недели между сменами почти сутки отдыха.
+  m_ctx->EraseElement(weekEnd);
+  StaffScheduleBuilder open(*m_ctx, logger);
+  open.ReadStaffData(restaurant);
+  open.BuildFlowNetwork();
+  EXPECT_EQ(open.FindMaxFlow(), 2u);
+}
+
+TEST_F(BuilderTest, PreferenceSolverAssignsPreferredShiftTypes)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr morningType = CreateShiftType(*m_ctx);
+  ScAddr eveningType = CreateShiftType(*m_ctx);
+  ScAddr morningShift = CreateShift(*m_ctx, morningType);
+  ScAddr eveningShift = CreateShift(*m_ctx, eveningType);
+  AddShiftToRestaurant(*m_ctx, restaurant, morningShift);
+  AddShiftToRestaurant(*m_ctx, restaurant, eveningShift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+
+  // Оба повара могут работать в любой смене, но одну в неделю; каждый предпочитает свою.
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> preferredShifts;
+  for (auto const & [preferredType, preferredShift, weight] :
+       {std::tuple(eveningType, eveningShift, "3"), std::tuple(morningType, morningShift, "")})
+  {
+    ScAddr cook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType, "1");
+    AddRelation(*m_ctx, cook, eveningType, StaffScheduleKeynodes::nrel_available_shift_type);
+    AddPreferredShiftType(*m_ctx, cook, preferredType, weight);
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+    preferredShifts[cook] = preferredShift;
+  }
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.FindMaxFlow(ScheduleSolverType::Preference), 2u);
+  builder.WriteSchedule();
+
+  for (auto const & employee : builder.GetEmployees())
+  {
+    ASSERT_EQ(employee.assignedShifts.size(), 1u);
+    EXPECT_EQ(employee.assignedShifts[0], preferredShifts.at(employee.addr));
+  }
+}
+
+TEST_F(BuilderTest, PreferenceWeightsAreLimited)
+{
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr morningType = CreateShiftType(*m_ctx);
+  ScAddr eveningType = CreateShiftType(*m_ctx);
+  ScAddr morningShift = CreateShift(*m_ctx, morningType);
+  ScAddr eveningShift = CreateShift(*m_ctx, eveningType);
+  AddShiftToRestaurant(*m_ctx, restaurant, morningShift);
+  AddShiftToRestaurant(*m_ctx, restaurant, eveningShift);
+  AddStaffingRequirement(*m_ctx, restaurant, StaffScheduleKeynodes::concept_cook, "1");
+
+  // Огромный вес ограничивается, отрицательный не учитывается, и решение остаётся дешёвым.
+  std::map<ScAddr, ScAddr, ScAddrLessFunc> expectedShifts;
+  for (auto const & [preferredType, expectedShift, weight] :
+       {std::tuple(eveningType, eveningShift, "1000000000"), std::tuple(eveningType, morningShift, "-5")})
+  {
+    ScAddr cook = CreateEmployeeWithMax(*m_ctx, StaffScheduleKeynodes::concept_cook, morningType, "1");
+    AddRelation(*m_ctx, cook, eveningType, StaffScheduleKeynodes::nrel_available_shift_type);
+    AddPreferredShiftType(*m_ctx, cook, preferredType, weight);
+    AddEmployeeToRestaurant(*m_ctx, restaurant, cook);
+    expectedShifts[cook] = expectedShift;
+  }
+
+  utils::ScLogger logger;
+  StaffScheduleBuilder builder(*m_ctx, logger);
+  builder.ReadStaffData(restaurant);
+  builder.BuildFlowNetwork();
+  EXPECT_EQ(builder.FindMaxFlow(ScheduleSolverType::Preference), 2u);
+  builder.WriteSchedule();
+
+  for (auto const & employee : builder.GetEmployees())
+  {
+    bool const limited = expectedShifts.at(employee.addr) == eveningShift;
+    ASSERT_EQ(employee.preferredShiftTypes.size(), limited ? 1u : 0u);
+    if (limited)
+    {
+      EXPECT_EQ(employee.preferredShiftTypes[0].weight, ShiftPreference::MaxWeight);
+    }
+    ASSERT_EQ(employee.assignedShifts.size(), 1u);
+    EXPECT_EQ(employee.assignedShifts[0], expectedShifts.at(employee.addr));
+  }
+}
@@ -0,0 +1,138 @@
+#include <sc-memory/test/sc_test.hpp>
+
+#include <sc-memory/sc_memory.hpp>
+#include <sc-memory/sc_iterator.hpp>
+
+#include "agent/build_staff_schedule_agent.hpp"
+#include "agent/repair_staff_schedule_agent.hpp"
+#include "keynodes/staff_schedule_keynodes.hpp"
+#include "staff_schedule_module.h"
+#include "test/staff_schedule_test_utils.hpp"
+
+#include <chrono>
+#include <thread>
+
+using MaintenanceTest = ScMemoryTest;
+
+namespace
+{
+std::chrono::milliseconds const kDebounce(50);
+
+void SubscribeMaintenance(ScAgentContext & ctx)
+{
+  ctx.SubscribeAgent<BuildStaffScheduleAgent>();
+  ctx.SubscribeAgent<RepairStaffScheduleAgent>();
+  StaffScheduleModule::GetScheduleMaintainer().Start(kDebounce);
+}
+
+void UnsubscribeMaintenance(ScAgentContext & ctx)
+{
+  StaffScheduleModule::GetScheduleMaintainer().Stop();
+  ctx.UnsubscribeAgent<RepairStaffScheduleAgent>();
+  ctx.UnsubscribeAgent<BuildStaffScheduleAgent>();
+}
+
+//! Waits until the maintainer completes the given number of repairs, then for a few more debounce intervals.
+size_t WaitForRepairs(size_t expected)
+{
+  StaffScheduleMaintainer const & maintainer = StaffScheduleModule::GetScheduleMaintainer();
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (maintainer.GetRepairCount() < expected && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  std::this_thread::sleep_for(kDebounce * 4);
+  return maintainer.GetRepairCount();
+}
+
+size_t GetAssignedCount(ScMemoryContext & ctx, ScAddr const & shift)
+{
+  ScIterator5Ptr it = ctx.CreateIterator5(
+      shift,
+      ScType::ConstCommonArc,
+      ScType::ConstNode,
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::nrel_assigned_employee);
+  size_t count = 0;
+  while (it->Next())
+    count++;
+  return count;
+}
+}  // namespace
+
+TEST_F(MaintenanceTest, StaffChangesAreCoalescedIntoOneRepair)
+{
+  SubscribeMaintenance(*m_ctx);
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayShiftType = CreateShiftType(*m_ctx);
+  ScAddr shift = CreateShift(*m_ctx, dayShiftType);
+  for (ScAddr const & role :
+       {StaffScheduleKeynodes::concept_cook,
+        StaffScheduleKeynodes::concept_waiter,
+        StaffScheduleKeynodes::concept_cleaner,
+        StaffScheduleKeynodes::concept_admin})
+    AddEmployeeToRestaurant(*m_ctx, restaurant, CreateEmployee(*m_ctx, role, dayShiftType));
+
+  ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant);
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_EQ(GetAssignedCount(*m_ctx, shift), 4u);
+  EXPECT_EQ(WaitForRepairs(0), 0u);
+
+  // Импорт нескольких официантов: каждая правка порождает события, исправление должно быть одно.
+  for (size_t i = 0; i < 10; ++i)
+  {
+    ScAddr waiter = CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, dayShiftType);
+    AddEmployeeToRestaurant(*m_ctx, restaurant, waiter);
+  }
+
+  EXPECT_EQ(WaitForRepairs(1), 1u);
+  EXPECT_EQ(GetAssignedCount(*m_ctx, shift), 5u);
+
+  UnsubscribeMaintenance(*m_ctx);
+}
+
+TEST_F(MaintenanceTest, RequirementChangesRepairSchedule)
+{
+  SubscribeMaintenance(*m_ctx);
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr nightType = CreateShiftType(*m_ctx);
+  ScAddr fridayNight = CreateShift(*m_ctx, nightType);
+  AddShiftToRestaurant(*m_ctx, restaurant, fridayNight);
+  for (ScAddr const & role :
+       {StaffScheduleKeynodes::concept_cook,
+        StaffScheduleKeynodes::concept_cleaner,
+        StaffScheduleKeynodes::concept_admin})
+    AddEmployeeToRestaurant(*m_ctx, restaurant, CreateEmployee(*m_ctx, role, nightType));
+  for (size_t i = 0; i < 4; ++i)
+    AddEmployeeToRestaurant(
+        *m_ctx, restaurant, CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_waiter, nightType));
+
+  ScAction action = m_ctx->GenerateAction(StaffScheduleKeynodes::action_build_staff_schedule);
+  action.SetArguments(restaurant);
+  EXPECT_TRUE(action.InitiateAndWait());
+  EXPECT_EQ(GetAssignedCount(*m_ctx, fridayNight), 5u);
+
+  // В пятничную ночь нужно четыре официанта вместо двух.
+  AddStaffingRequirement(*m_ctx, fridayNight, StaffScheduleKeynodes::concept_waiter, "4");
+
+  EXPECT_EQ(WaitForRepairs(1), 1u);
+  EXPECT_EQ(GetAssignedCount(*m_ctx, fridayNight), 7u);
+
+  UnsubscribeMaintenance(*m_ctx);
+}
+
+TEST_F(MaintenanceTest, StaffChangesWithoutCurrentScheduleAreIgnored)
+{
+  SubscribeMaintenance(*m_ctx);
+
+  ScAddr restaurant = CreateRestaurant(*m_ctx);
+  ScAddr dayShiftType = CreateShiftType(*m_ctx);
+  CreateShift(*m_ctx, dayShiftType);
+  AddEmployeeToRestaurant(
+      *m_ctx, restaurant, CreateEmployee(*m_ctx, StaffScheduleKeynodes::concept_cook, dayShiftType));
+
+  EXPECT_EQ(WaitForRepairs(1), 0u);
+
+  UnsubscribeMaintenance(*m_ctx);
+}
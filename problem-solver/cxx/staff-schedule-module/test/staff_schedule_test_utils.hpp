@@ -0,0 +1,123 @@
+#pragma once
+
+#include <sc-memory/sc_memory.hpp>
+
+#include "keynodes/staff_schedule_keynodes.hpp"
+
+#include <string>
+
+inline void AddRelation(ScMemoryContext & ctx, ScAddr const & src, ScAddr const & trg, ScAddr const & rel)
+{
+  ScAddr arc = ctx.GenerateConnector(ScType::ConstCommonArc, src, trg);
+  ctx.GenerateConnector(ScType::ConstPermPosArc, rel, arc);
+}
+
+//! Adds owner => relation: [count], as restaurant settings and shift type hours are given.
+inline void AddCount(ScMemoryContext & ctx, ScAddr const & owner, ScAddr const & relation, std::string const & count)
+{
+  ScAddr link = ctx.GenerateLink();
+  ctx.SetLinkContent(link, count);
+  AddRelation(ctx, owner, link, relation);
+}
+
+//! Adds employee => nrel_preferred_shift_type: shiftType, with the weight on the arc unless it is empty.
+inline void AddPreferredShiftType(
+    ScMemoryContext & ctx,
+    ScAddr const & employee,
+    ScAddr const & shiftType,
+    std::string const & weight = "")
+{
+  ScAddr arc = ctx.GenerateConnector(ScType::ConstCommonArc, employee, shiftType);
+  ctx.GenerateConnector(ScType::ConstPermPosArc, StaffScheduleKeynodes::nrel_preferred_shift_type, arc);
+  if (!weight.empty())
+    AddCount(ctx, arc, StaffScheduleKeynodes::nrel_preference_weight, weight);
+}
+
+inline ScAddr CreateShiftType(ScMemoryContext & ctx)
+{
+  ScAddr shiftType = ctx.GenerateNode(ScType::ConstNode);
+  ctx.GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::concept_shift_type,
+      shiftType);
+  return shiftType;
+}
+
+inline ScAddr CreateEmployeeWithMax(
+    ScMemoryContext & ctx,
+    ScAddr const & role,
+    ScAddr const & availableShiftType,
+    std::string const & maxShifts)
+{
+  ScAddr employee = ctx.GenerateNode(ScType::ConstNode);
+  ctx.GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::concept_employee,
+      employee);
+
+  AddRelation(ctx, employee, role, StaffScheduleKeynodes::nrel_has_role);
+  AddRelation(ctx, employee, availableShiftType, StaffScheduleKeynodes::nrel_available_shift_type);
+
+  ScAddr maxLink = ctx.GenerateLink();
+  ctx.SetLinkContent(maxLink, maxShifts);
+  AddRelation(ctx, employee, maxLink, StaffScheduleKeynodes::nrel_max_shifts_per_week);
+
+  return employee;
+}
+
+inline ScAddr CreateEmployee(ScMemoryContext & ctx, ScAddr const & role, ScAddr const & availableShiftType)
+{
+  return CreateEmployeeWithMax(ctx, role, availableShiftType, "5");
+}
+
+inline ScAddr CreateShift(ScMemoryContext & ctx, ScAddr const & shiftType)
+{
+  ScAddr shift = ctx.GenerateNode(ScType::ConstNode);
+  ctx.GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::concept_shift,
+      shift);
+  AddRelation(ctx, shift, shiftType, StaffScheduleKeynodes::nrel_shift_type);
+  return shift;
+}
+
+inline ScAddr CreateRestaurant(ScMemoryContext & ctx)
+{
+  ScAddr restaurant = ctx.GenerateNode(ScType::ConstNode);
+  ctx.GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::concept_restaurant,
+      restaurant);
+  return restaurant;
+}
+
+inline void AddEmployeeToRestaurant(ScMemoryContext & ctx, ScAddr const & restaurant, ScAddr const & employee)
+{
+  AddRelation(ctx, restaurant, employee, StaffScheduleKeynodes::nrel_has_employee);
+}
+
+inline void AddShiftToRestaurant(ScMemoryContext & ctx, ScAddr const & restaurant, ScAddr const & shift)
+{
+  AddRelation(ctx, restaurant, shift, StaffScheduleKeynodes::nrel_has_shift);
+}
+
+inline ScAddr AddStaffingRequirement(
+    ScMemoryContext & ctx,
+    ScAddr const & owner,
+    ScAddr const & role,
+    std::string const & count)
+{
+  ScAddr requirement = ctx.GenerateNode(ScType::ConstNode);
+  ctx.GenerateConnector(
+      ScType::ConstPermPosArc,
+      StaffScheduleKeynodes::concept_staffing_requirement,
+      requirement);
+  AddRelation(ctx, requirement, role, StaffScheduleKeynodes::nrel_required_role);
+
+  ScAddr countLink = ctx.GenerateLink();
+  ctx.SetLinkContent(countLink, count);
+  AddRelation(ctx, requirement, countLink, StaffScheduleKeynodes::nrel_required_count);
+
+  AddRelation(ctx, owner, requirement, StaffScheduleKeynodes::nrel_staffing_requirement);
+  return requirement;
+}